@@ -3,7 +3,18 @@
 rm -f error*
 rm -f core
 
-# change 0x610661c3 to your semaphore and shared memory key
-ipcrm -S 0x6107f702
-ipcrm -M 0x6107f702
+# semaphore sets and shared regions of the keys in the registry (see ipcRegistry.h); the generator reclaims the ones
+# left by terminated runs by itself, so this is only needed to remove everything at once, with no run going on
+if [ -f airlift.lock ]; then
+    while read key owner; do
+        ipcrm -S $key 2>/dev/null
+        ipcrm -M $key 2>/dev/null
+    done < airlift.lock
+    rm -f airlift.lock
+fi
 
+# semaphore sets of the futex build (make futexsem)
+rm -f /dev/shm/airlift_sem_*
+
+# shared regions of the POSIX shared memory build (make posixshm)
+rm -f /dev/shm/airlift_shm_*
@@ -1,4 +1,4 @@
 #!/bin/bash
 
-./probSemSharedMemAirLift | awk -f filter_log.awk
-
+# the lines of state are written in the delta format by the simulation itself (see logExpand)
+./probSemSharedMemAirLift -d "$@"
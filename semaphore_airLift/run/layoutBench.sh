@@ -0,0 +1,15 @@
+#!/bin/bash
+
+# side by side benchmark of the layouts of the full state (build them with "make bench" in ../src)
+# the cache misses are counted as well if perf is available
+# usage: layoutBench.sh [-n iterations] [-p processes]
+
+for b in packed padded
+do
+     if command -v perf >/dev/null
+     then
+          perf stat -e cache-misses,cache-references ./layoutBench_$b "$@" || exit 1
+     else
+          ./layoutBench_$b "$@" || exit 1
+     fi
+done
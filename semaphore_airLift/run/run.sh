@@ -1,9 +1,13 @@
 #!/bin/bash
 
+# the runs go on several at a time, each with its own key and logging file (batch/log_<run>); the summaries are
+# aggregated by probBatchAirLift and the logs may be checked with ./logCheck batch
+
 case $# in
     0) n=1000;;
     1) n=$1;;
-    *) echo "USAGE: $0 «number-of-runs»"; exit;;
+    2) n=$1; j=$2;;
+    *) echo "USAGE: $0 «number-of-runs» [«runs-at-a-time»]"; exit;;
 esac
 
 if ! [ $n -gt 0 ] 2>/dev/null; then
@@ -11,8 +15,9 @@ if ! [ $n -gt 0 ] 2>/dev/null; then
     exit 1
 fi
 
-for i in $(seq 1 $n)
-do
-     echo -e "\n\e[34;1mRun n.º $i\e[0m"
-     ./probSemSharedMemAirLift
-done
+if [ -n "$j" ] && ! [ $j -gt 0 ] 2>/dev/null; then
+    echo "Wrong argument value (\"$j\"). Aborting."
+    exit 1
+fi
+
+./probBatchAirLift -n $n ${j:+-j $j}
@@ -0,0 +1,9 @@
+#!/bin/bash
+
+# side by side benchmark of the semaphore implementations (build them with "make bench" in ../src)
+# usage: semBench.sh [-n iterations] [-p processes]
+
+for b in sysv futex posix
+do
+     ./semBench_$b "$@" || exit 1
+done
@@ -0,0 +1,31 @@
+#!/bin/bash
+
+# number of semaphore system calls per entity of the SVIPC build (build it with "make all", or with "make splitsem"
+# for the count before the operations were joined by semOps, and the counter with "make count" in ../src)
+# usage: semCount.sh [number-of-runs]
+
+case $# in
+    0) n=10;;
+    1) n=$1;;
+    *) echo "USAGE: $0 «number-of-runs»"; exit 1;;
+esac
+
+if ! [ $n -gt 0 ] 2>/dev/null; then
+    echo "Wrong argument value (\"$n\"). Aborting."
+    exit 1
+fi
+
+rm -f semCount.log
+for i in $(seq 1 $n)
+do
+     SEMCOUNT_LOG=semCount.log LD_PRELOAD=$PWD/libsemCount.so ./probSemSharedMemAirLift log_semCount > /dev/null || exit 1
+done
+rm -f log_semCount
+
+awk -v runs=$n '{ calls[$1] += $2; procs[$1] += 1; total += $2 }
+     END { printf ("%-24s %10s %12s\n", "Program", "Processes", "Calls/proc")
+           for (p in calls)
+               printf ("%-24s %10d %12.1f\n", p, procs[p], calls[p] / procs[p])
+           if (procs["passenger"] > 0)
+               printf ("\n%.1f calls per passenger, all entities included\n", total / procs["passenger"])
+         }' semCount.log
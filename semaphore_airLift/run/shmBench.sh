@@ -0,0 +1,9 @@
+#!/bin/bash
+
+# side by side benchmark of the shared memory implementations (build them with "make bench" in ../src)
+# usage: shmBench.sh [-n slots] [-b slot size] [-a accesses]
+
+for b in sysv posix thp
+do
+     ./shmBench_$b "$@" || exit 1
+done
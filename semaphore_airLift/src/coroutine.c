@@ -0,0 +1,439 @@
+/**
+ *  \file coroutine.c (implementation file)
+ *
+ *  \brief Problem name: Air Lift.
+ *
+ *  \brief Coroutines multiplexed on a single thread.
+ *
+ *  Implementation based on the <tt>ucontext</tt> functions. The scheduler runs on the stack of its thread and
+ *  every switch goes through it: it copies the stack of the coroutine it resumes back into place, and the one of
+ *  the coroutine that suspended aside, so the shared stack is never in use by the thread doing the copies. A
+ *  coroutine is only given its context, on the shared stack, when it first runs.
+ *
+ *  The ready coroutines and the ones waiting in a queue are linked through the coroutines themselves; the sleeping
+ *  ones are kept in a binary heap ordered by the time they are due.
+ */
+
+#ifdef SEM_CORO
+
+#define _GNU_SOURCE                                                        /* for the registers of the saved contexts */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <ucontext.h>
+
+#include "coroutine.h"
+
+/**
+ *  \brief Definition of <em>coroutine</em> data type.
+ */
+struct coTask
+       { /** \brief context, while suspended */
+         ucontext_t ctx;
+         /** \brief function the coroutine runs */
+         void *(*fn) (void *);
+         /** \brief argument of the function */
+         void *arg;
+         /** \brief the coroutine has run */
+         bool started;
+         /** \brief the function has returned */
+         bool over;
+         /** \brief stack pointer of the saved context: lowest address of the shared stack in use, while suspended */
+         char *sp;
+         /** \brief copy of the part of the shared stack in use, while suspended */
+         char *saved;
+         /** \brief number of bytes of the copy */
+         size_t nSaved;
+         /** \brief size of the buffer of the copy */
+         size_t capSaved;
+         /** \brief time the coroutine is due, while sleeping (in us) */
+         unsigned long long wake;
+         /** \brief next coroutine in the queue the coroutine is in */
+         CO_TASK *next;
+       };
+
+/** \brief stack shared by the coroutines */
+static char *stack = NULL;
+
+/** \brief size of the shared stack */
+static size_t stackSize = 0;
+
+/** \brief context of the scheduler, while a coroutine runs */
+static ucontext_t schedCtx;
+
+/** \brief running coroutine of the thread (NULL, out of a coroutine) */
+static _Thread_local CO_TASK *cur = NULL;
+
+/** \brief queue of ready coroutines */
+static CO_QUEUE ready;
+
+/** \brief heap of sleeping coroutines */
+static CO_TASK **sleepers = NULL;
+
+/** \brief number of sleeping coroutines */
+static size_t nSleep = 0;
+
+/** \brief size of the heap of sleeping coroutines */
+static size_t capSleep = 0;
+
+/** \brief number of coroutines not over */
+static unsigned long nLive = 0;
+
+/** \brief total of the buffers of the saved stacks */
+static size_t totalSaved = 0;
+
+/** \brief figures of the coroutines */
+static CO_STATS stats;
+
+/**
+ *  \brief Getting the present time in us.
+ */
+
+static unsigned long long nowUs (void)
+{
+  struct timespec t;
+
+  clock_gettime (CLOCK_MONOTONIC, &t);
+  return (unsigned long long) t.tv_sec * 1000000ULL + (unsigned long long) t.tv_nsec / 1000ULL;
+}
+
+/**
+ *  \brief Appending a coroutine to a queue.
+ */
+
+static void push (CO_QUEUE *q, CO_TASK *t)
+{
+  t->next = NULL;
+  if (q->tail == NULL)
+     q->head = t;
+     else q->tail->next = t;
+  q->tail = t;
+}
+
+/**
+ *  \brief Taking the first coroutine of a queue (NULL, if it is empty).
+ */
+
+static CO_TASK *pop (CO_QUEUE *q)
+{
+  CO_TASK *t = q->head;
+
+  if (t != NULL)
+     { if ((q->head = t->next) == NULL)
+          q->tail = NULL;
+     }
+  return t;
+}
+
+/**
+ *  \brief Putting the running coroutine in the heap of sleeping coroutines.
+ *
+ *  \return \c 0, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+static int sleepPush (CO_TASK *t)
+{
+  size_t i, parent;
+
+  if (nSleep == capSleep)
+     { size_t cap = (capSleep == 0) ? 64 : 2 * capSleep;
+       CO_TASK **heap;
+
+       if ((heap = realloc (sleepers, cap * sizeof (CO_TASK *))) == NULL)
+          return -1;
+       sleepers = heap;
+       capSleep = cap;
+     }
+  for (i = nSleep++; i > 0; i = parent)                                          /* sift it up from the bottom */
+  { parent = (i - 1) / 2;
+    if (sleepers[parent]->wake <= t->wake)
+       break;
+    sleepers[i] = sleepers[parent];
+  }
+  sleepers[i] = t;
+  return 0;
+}
+
+/**
+ *  \brief Taking the sleeping coroutine that is due first.
+ */
+
+static CO_TASK *sleepPop (void)
+{
+  CO_TASK *t = sleepers[0], *last = sleepers[--nSleep];
+  size_t i = 0, child;
+
+  while ((child = 2 * i + 1) < nSleep)                                            /* sift the last one down */
+  { if ((child + 1 < nSleep) && (sleepers[child+1]->wake < sleepers[child]->wake))
+       child += 1;
+    if (sleepers[child]->wake >= last->wake)
+       break;
+    sleepers[i] = sleepers[child];
+    i = child;
+  }
+  sleepers[i] = last;
+  return t;
+}
+
+/**
+ *  \brief Getting the stack pointer of a saved context.
+ *
+ *  Nothing below it is in use by the suspended coroutine: <tt>swapcontext</tt> is never called from a leaf
+ *  function, so no data is kept in the red zone.
+ *
+ *  \param ctx pointer to the context
+ *
+ *  \return stack pointer
+ */
+
+static char *ctxSp (const ucontext_t *ctx)
+{
+#if defined (__x86_64__)
+  return (char *) ctx->uc_mcontext.gregs[REG_RSP];
+#elif defined (__i386__)
+  return (char *) ctx->uc_mcontext.gregs[REG_ESP];
+#elif defined (__aarch64__)
+  return (char *) ctx->uc_mcontext.sp;
+#else
+#error "the stack pointer of a saved context is not known on this architecture"
+#endif
+}
+
+/**
+ *  \brief Suspending the running coroutine and switching to the scheduler.
+ */
+
+static void coSuspend (void)
+{
+  swapcontext (&cur->ctx, &schedCtx);
+}
+
+/**
+ *  \brief Starting point of every coroutine.
+ */
+
+static void coEntry (void)
+{
+  cur->fn (cur->arg);
+  cur->over = true;
+  setcontext (&schedCtx);                                                    /* the stack is left for good */
+}
+
+/**
+ *  \brief Resuming a coroutine until it suspends or is over.
+ *
+ *  The stack of the coroutine is copied back into place before and aside after.
+ */
+
+static void resume (CO_TASK *t)
+{
+  size_t size;
+
+  if (!t->started)
+     { getcontext (&t->ctx);
+       t->ctx.uc_stack.ss_sp = stack;
+       t->ctx.uc_stack.ss_size = stackSize;
+       t->ctx.uc_link = NULL;
+       makecontext (&t->ctx, coEntry, 0);
+       t->started = true;
+     }
+     else memcpy (t->sp, t->saved, t->nSaved);
+  cur = t;
+  stats.nSwitches += 1;
+  swapcontext (&schedCtx, &t->ctx);
+  cur = NULL;
+
+  if (t->over)
+     { totalSaved -= t->capSaved;
+       free (t->saved);
+       free (t);
+       nLive -= 1;
+       return;
+     }
+  t->sp = ctxSp (&t->ctx);
+  if ((t->sp < stack) || (t->sp > stack + stackSize))
+     { errno = EFAULT;
+       perror ("error on saving the stack of a coroutine");
+       exit (EXIT_FAILURE);
+     }
+  size = (size_t) (stack + stackSize - t->sp);
+  if (size > t->capSaved)
+     { char *buf;
+
+       if ((buf = realloc (t->saved, size)) == NULL)
+          { perror ("error on saving the stack of a coroutine");
+            exit (EXIT_FAILURE);
+          }
+       totalSaved += size - t->capSaved;
+       t->saved = buf;
+       t->capSaved = size;
+       if (size > stats.maxSaved)
+          stats.maxSaved = size;
+       if (totalSaved > stats.peakSaved)
+          stats.peakSaved = totalSaved;
+     }
+  memcpy (t->saved, t->sp, size);
+  t->nSaved = size;
+}
+
+/**
+ *  \brief Setting up the scheduler.
+ *
+ *  \param size size of the stack shared by the coroutines (in bytes)
+ *
+ *  \return \c 0, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+int coInit (size_t size)
+{
+  if ((stack = malloc (size)) == NULL)
+     return -1;
+  stackSize = size;
+  memset (&ready, 0, sizeof (ready));
+  memset (&stats, 0, sizeof (stats));
+  nSleep = 0;
+  nLive = 0;
+  totalSaved = 0;
+  return 0;
+}
+
+/**
+ *  \brief Creating a coroutine, ready to run.
+ *
+ *  \param fn function the coroutine runs
+ *  \param arg argument of the function
+ *
+ *  \return \c 0, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+int coSpawn (void *(*fn) (void *), void *arg)
+{
+  CO_TASK *t;
+
+  if ((t = calloc (1, sizeof (CO_TASK))) == NULL)
+     return -1;
+  t->fn = fn;
+  t->arg = arg;
+  push (&ready, t);
+  nLive += 1;
+  stats.nCreated += 1;
+  return 0;
+}
+
+/**
+ *  \brief Running the coroutines in the calling thread.
+ *
+ *  \return number of coroutines left waiting
+ */
+
+unsigned long coRun (void)
+{
+  CO_TASK *t;
+  unsigned long long now;
+  struct timespec due;
+
+  for (;;)
+  { if (nSleep > 0)                                                     /* the sleeping ones that are due get ready */
+       { now = nowUs ();
+         while ((nSleep > 0) && (sleepers[0]->wake <= now))
+           push (&ready, sleepPop ());
+       }
+    if ((t = pop (&ready)) != NULL)
+       { resume (t);
+         continue;
+       }
+    if (nSleep == 0)                                                                      /* over, or all waiting */
+       break;
+    due.tv_sec = (time_t) (sleepers[0]->wake / 1000000ULL);
+    due.tv_nsec = (long) (sleepers[0]->wake % 1000000ULL) * 1000L;
+    clock_nanosleep (CLOCK_MONOTONIC, TIMER_ABSTIME, &due, NULL);
+  }
+  free (stack);
+  free (sleepers);
+  stack = NULL;
+  sleepers = NULL;
+  capSleep = 0;
+  return nLive;
+}
+
+/**
+ *  \brief Testing if the calling thread runs a coroutine.
+ *
+ *  \return \c true, if it does
+ */
+
+bool coInside (void)
+{
+  return cur != NULL;
+}
+
+/**
+ *  \brief Suspending the running coroutine at the end of a queue, until it is woken up.
+ *
+ *  \param q pointer to the queue
+ */
+
+void coWait (CO_QUEUE *q)
+{
+  push (q, cur);
+  coSuspend ();
+}
+
+/**
+ *  \brief Waking up the first coroutine of a queue.
+ *
+ *  \param q pointer to the queue
+ *
+ *  \return \c true, if a coroutine was woken up
+ *  \return \c false, if the queue is empty
+ */
+
+bool coWake (CO_QUEUE *q)
+{
+  CO_TASK *t;
+
+  if ((t = pop (q)) == NULL)
+     return false;
+  push (&ready, t);
+  return true;
+}
+
+/**
+ *  \brief Sleeping.
+ *
+ *  \param usec sleeping time (in us)
+ *
+ *  \return \c 0, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+int coSleep (unsigned int usec)
+{
+  if (cur == NULL)
+     return usleep (usec);
+  cur->wake = nowUs () + usec;
+  if (sleepPush (cur) == -1)
+     return -1;
+  coSuspend ();
+  return 0;
+}
+
+/**
+ *  \brief Getting the figures of the coroutines.
+ *
+ *  \param pStats pointer to the location where the figures are stored
+ */
+
+void coStats (CO_STATS *pStats)
+{
+  *pStats = stats;
+  pStats->taskSize = sizeof (CO_TASK);
+}
+
+#endif /* SEM_CORO */
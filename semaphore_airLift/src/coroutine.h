@@ -0,0 +1,139 @@
+/**
+ *  \file coroutine.h (interface file)
+ *
+ *  \brief Problem name: Air Lift.
+ *
+ *  \brief Coroutines multiplexed on a single thread.
+ *
+ *  The coroutines are stackful: each one runs a function that may suspend anywhere down its calls, waiting in a
+ *  queue until another coroutine wakes it up, or sleeping for some time. They are run one at a time, in the order
+ *  they became ready, by a scheduler that sleeps when none is ready until the first sleeping one is due.
+ *
+ *  All coroutines run on the same large stack. When one suspends, the part of the stack it uses, typically a few
+ *  hundred bytes, is copied aside and copied back before it resumes, so the memory of a suspended coroutine is little
+ *  more than its context, whatever the depth its function reaches between suspensions.
+ *
+ *  Built with <tt>SEM_CORO</tt> defined (see <tt>semaphoreCoro.c</tt>).
+ */
+
+#ifndef COROUTINE_H_
+#define COROUTINE_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/** \brief coroutine (opaque) */
+typedef struct coTask CO_TASK;
+
+/**
+ *  \brief Definition of <em>queue of suspended coroutines</em> data type (empty, when all bytes are 0).
+ */
+typedef struct
+        { /** \brief first coroutine (NULL, if none) */
+          CO_TASK *head;
+          /** \brief last coroutine (NULL, if none) */
+          CO_TASK *tail;
+
+        } CO_QUEUE;
+
+/**
+ *  \brief Definition of <em>coroutine figures</em> data type.
+ */
+typedef struct
+        { /** \brief number of coroutines created */
+          unsigned long nCreated;
+          /** \brief number of times a coroutine was resumed */
+          unsigned long nSwitches;
+          /** \brief bytes of a coroutine, not counting its saved stack */
+          size_t taskSize;
+          /** \brief largest saved stack of a coroutine (in bytes) */
+          size_t maxSaved;
+          /** \brief largest total of the saved stacks of the coroutines (in bytes) */
+          size_t peakSaved;
+
+        } CO_STATS;
+
+/**
+ *  \brief Setting up the scheduler.
+ *
+ *  \param size size of the stack shared by the coroutines (in bytes)
+ *
+ *  \return \c 0, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+extern int coInit (size_t size);
+
+/**
+ *  \brief Creating a coroutine, ready to run.
+ *
+ *  \param fn function the coroutine runs; the coroutine is over when it returns
+ *  \param arg argument of the function
+ *
+ *  \return \c 0, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+extern int coSpawn (void *(*fn) (void *), void *arg);
+
+/**
+ *  \brief Running the coroutines in the calling thread.
+ *
+ *  The function returns when every coroutine is over, or every one left waits in a queue.
+ *
+ *  \return number of coroutines left waiting
+ */
+
+extern unsigned long coRun (void);
+
+/**
+ *  \brief Testing if the calling thread runs a coroutine.
+ *
+ *  \return \c true, if it does
+ */
+
+extern bool coInside (void);
+
+/**
+ *  \brief Suspending the running coroutine at the end of a queue, until it is woken up.
+ *
+ *  \param q pointer to the queue
+ */
+
+extern void coWait (CO_QUEUE *q);
+
+/**
+ *  \brief Waking up the first coroutine of a queue.
+ *
+ *  The coroutine becomes ready; it runs after the ones already ready.
+ *
+ *  \param q pointer to the queue
+ *
+ *  \return \c true, if a coroutine was woken up
+ *  \return \c false, if the queue is empty
+ */
+
+extern bool coWake (CO_QUEUE *q);
+
+/**
+ *  \brief Sleeping.
+ *
+ *  The running coroutine is suspended for <tt>usec</tt> us at least; out of a coroutine, the thread sleeps.
+ *
+ *  \param usec sleeping time (in us)
+ *
+ *  \return \c 0, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+extern int coSleep (unsigned int usec);
+
+/**
+ *  \brief Getting the figures of the coroutines.
+ *
+ *  \param pStats pointer to the location where the figures are stored
+ */
+
+extern void coStats (CO_STATS *pStats);
+
+#endif /* COROUTINE_H_ */
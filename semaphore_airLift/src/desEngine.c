@@ -0,0 +1,217 @@
+/**
+ *  \file desEngine.c (implementation file)
+ *
+ *  \brief Problem name: Air Lift.
+ *
+ *  \brief Discrete-event simulation engine.
+ *
+ *  The scheduled entities are kept in a binary heap ordered by time and, for the same time, by the order they were
+ *  scheduled in; the lists of blocked entities are linked through an array indexed by entity.
+ */
+
+#include <stdlib.h>
+#include <errno.h>
+
+#include "desEngine.h"
+
+/**
+ *  \brief Definition of <em>scheduled entity</em> data type.
+ */
+typedef struct
+        { /** \brief time the entity runs at (in us) */
+          unsigned long long time;
+          /** \brief order the entity was scheduled in */
+          unsigned long long seq;
+          /** \brief entity */
+          unsigned int ent;
+
+        } DES_EVENT;
+
+/** \brief heap of scheduled entities */
+static DES_EVENT *heap = NULL;
+
+/** \brief number of scheduled entities */
+static unsigned int nHeap = 0;
+
+/** \brief next entity of the list of blocked entities an entity is in, for every entity */
+static unsigned int *waitNext = NULL;
+
+/** \brief virtual clock (in us) */
+static unsigned long long vClock = 0;
+
+/** \brief number of times an entity was scheduled */
+static unsigned long long nSched = 0;
+
+/**
+ *  \brief Testing if a scheduled entity runs before another.
+ *
+ *  \param a pointer to the first scheduled entity
+ *  \param b pointer to the second scheduled entity
+ *
+ *  \return \c true, if the first one runs before
+ */
+
+static inline bool before (const DES_EVENT *a, const DES_EVENT *b)
+{
+    return (a->time < b->time) || ((a->time == b->time) && (a->seq < b->seq));
+}
+
+/**
+ *  \brief Starting the engine.
+ *
+ *  \param nEnt number of entities
+ *
+ *  \return \c 0, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+int desInit (unsigned int nEnt)
+{
+    desEnd ();
+    if (((heap = malloc (nEnt * sizeof (DES_EVENT))) == NULL) ||
+        ((waitNext = malloc (nEnt * sizeof (unsigned int))) == NULL)) {
+        desEnd ();
+        errno = ENOMEM;
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ *  \brief Stopping the engine and releasing its memory.
+ */
+
+void desEnd (void)
+{
+    free (heap);
+    free (waitNext);
+    heap = NULL;
+    waitNext = NULL;
+    nHeap = 0;
+    vClock = 0;
+    nSched = 0;
+}
+
+/**
+ *  \brief Getting the virtual clock.
+ *
+ *  \return present time (in us)
+ */
+
+unsigned long long desNow (void)
+{
+    return vClock;
+}
+
+/**
+ *  \brief Scheduling an entity that is neither scheduled nor blocked.
+ *
+ *  \param ent entity
+ *  \param delay time until the entity runs again (in us)
+ */
+
+void desSchedule (unsigned int ent, unsigned long long delay)
+{
+    DES_EVENT ev = { vClock + delay, nSched++, ent };                                       /* the new entity */
+    unsigned int i = nHeap++, parent;
+
+    while (i > 0) {                                                                  /* sift it up from the bottom */
+        parent = (i - 1) / 2;
+        if (!before (&ev, &heap[parent])) {
+            break;
+        }
+        heap[i] = heap[parent];
+        i = parent;
+    }
+    heap[i] = ev;
+}
+
+/**
+ *  \brief Taking the next entity to run.
+ *
+ *  \param pEnt pointer to the location where the entity is stored
+ *
+ *  \return \c true, if an entity was taken
+ *  \return \c false, if no entity is scheduled
+ */
+
+bool desNext (unsigned int *pEnt)
+{
+    DES_EVENT last;                                                                   /* the last entity of the heap */
+    unsigned int i = 0, child;
+
+    if (nHeap == 0) {
+        return false;
+    }
+    *pEnt = heap[0].ent;
+    vClock = heap[0].time;
+    last = heap[--nHeap];
+    while ((child = 2 * i + 1) < nHeap) {                                          /* sift it down from the root */
+        if ((child + 1 < nHeap) && before (&heap[child+1], &heap[child])) {
+            child += 1;
+        }
+        if (!before (&heap[child], &last)) {
+            break;
+        }
+        heap[i] = heap[child];
+        i = child;
+    }
+    heap[i] = last;
+    return true;
+}
+
+/**
+ *  \brief Initializing a virtual semaphore.
+ *
+ *  \param sem pointer to the semaphore
+ *  \param val initial value
+ */
+
+void desSemInit (DES_SEM *sem, unsigned int val)
+{
+    sem->val = val;
+    sem->head = sem->tail = DES_NONE;
+}
+
+/**
+ *  \brief Down operation on a virtual semaphore.
+ *
+ *  \param sem pointer to the semaphore
+ *  \param ent entity
+ *
+ *  \return \c true, if the entity goes on running
+ *  \return \c false, if it blocked
+ */
+
+bool desDown (DES_SEM *sem, unsigned int ent)
+{
+    if (sem->val > 0) {
+        sem->val -= 1;
+        return true;
+    }
+    waitNext[ent] = DES_NONE;
+    if (sem->tail == DES_NONE) {
+        sem->head = ent;
+    }
+    else waitNext[sem->tail] = ent;
+    sem->tail = ent;
+    return false;
+}
+
+/**
+ *  \brief Up operation on a virtual semaphore.
+ *
+ *  \param sem pointer to the semaphore
+ *  \param n increment
+ */
+
+void desUp (DES_SEM *sem, unsigned int n)
+{
+    for (; (n > 0) && (sem->head != DES_NONE); n--) {                             /* release the blocked entities */
+        desSchedule (sem->head, 0);
+        if ((sem->head = waitNext[sem->head]) == DES_NONE) {
+            sem->tail = DES_NONE;
+        }
+    }
+    sem->val += n;
+}
@@ -0,0 +1,127 @@
+/**
+ *  \file desEngine.h (interface file)
+ *
+ *  \brief Problem name: Air Lift.
+ *
+ *  \brief Discrete-event simulation engine.
+ *
+ *  The intervening entities are state machines, numbered from 0, that run one at a time in a single process. An
+ *  entity runs until it sleeps (it is scheduled after a delay on the virtual clock) or blocks on a virtual semaphore
+ *  (it is scheduled at the present time by the <em>up</em> operation that releases it). The scheduler takes the
+ *  entities in time order from a binary heap, those scheduled at the same time in the order they were scheduled, and
+ *  advances the virtual clock to the time of each one, so that the simulation takes no real time beyond the work of
+ *  the entities and, for a given sequence of delays, always runs the same way.
+ *
+ *  As only one entity runs at a time, a critical region needs no semaphore as long as the entity does not sleep or
+ *  block inside it.
+ *
+ *  An entity is either running, scheduled once, blocked on a single semaphore or over, so the heap holds one slot
+ *  per entity and the semaphores share a single array of links for their lists of blocked entities.
+ */
+
+#ifndef DESENGINE_H_
+#define DESENGINE_H_
+
+#include <stdbool.h>
+
+/** \brief end of a list of blocked entities */
+#define  DES_NONE       ((unsigned int) -1)
+
+/**
+ *  \brief Definition of <em>virtual semaphore</em> data type.
+ */
+typedef struct
+        { /** \brief value */
+          unsigned int val;
+          /** \brief first of the entities blocked on the semaphore (<tt>DES_NONE</tt>, if none) */
+          unsigned int head;
+          /** \brief last of the entities blocked on the semaphore (<tt>DES_NONE</tt>, if none) */
+          unsigned int tail;
+
+        } DES_SEM;
+
+/**
+ *  \brief Starting the engine.
+ *
+ *  The virtual clock is set to 0 and no entity is scheduled.
+ *
+ *  \param nEnt number of entities
+ *
+ *  \return \c 0, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+extern int desInit (unsigned int nEnt);
+
+/**
+ *  \brief Stopping the engine and releasing its memory.
+ */
+
+extern void desEnd (void);
+
+/**
+ *  \brief Getting the virtual clock.
+ *
+ *  \return present time (in us)
+ */
+
+extern unsigned long long desNow (void);
+
+/**
+ *  \brief Scheduling an entity that is neither scheduled nor blocked.
+ *
+ *  \param ent entity
+ *  \param delay time until the entity runs again (in us)
+ */
+
+extern void desSchedule (unsigned int ent, unsigned long long delay);
+
+/**
+ *  \brief Taking the next entity to run.
+ *
+ *  The virtual clock is advanced to the time the entity was scheduled at.
+ *
+ *  \param pEnt pointer to the location where the entity is stored
+ *
+ *  \return \c true, if an entity was taken
+ *  \return \c false, if no entity is scheduled
+ */
+
+extern bool desNext (unsigned int *pEnt);
+
+/**
+ *  \brief Initializing a virtual semaphore.
+ *
+ *  \param sem pointer to the semaphore
+ *  \param val initial value
+ */
+
+extern void desSemInit (DES_SEM *sem, unsigned int val);
+
+/**
+ *  \brief Down operation on a virtual semaphore.
+ *
+ *  If the value is 0, the entity is appended to the list of blocked entities.
+ *
+ *  \param sem pointer to the semaphore
+ *  \param ent entity
+ *
+ *  \return \c true, if the entity goes on running
+ *  \return \c false, if it blocked: it must return to the scheduler, which runs it again after the matching up
+ */
+
+extern bool desDown (DES_SEM *sem, unsigned int ent);
+
+/**
+ *  \brief Up operation on a virtual semaphore.
+ *
+ *  As many blocked entities as possible, up to <tt>n</tt>, are released in the order they blocked and scheduled at
+ *  the present time; the value is incremented by the rest.
+ *
+ *  \param sem pointer to the semaphore
+ *  \param n increment
+ */
+
+extern void desUp (DES_SEM *sem, unsigned int n);
+
+#endif /* DESENGINE_H_ */
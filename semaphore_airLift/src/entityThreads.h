@@ -0,0 +1,103 @@
+/**
+ *  \file entityThreads.h (interface file)
+ *
+ *  \brief Problem name: Air Lift.
+ *
+ *  \brief Life cycles of the intervening entities.
+ *
+ *  Each entity source provides the life cycle of the entity, which its main program runs. When compiled with
+ *  <tt>THREADED</tt> defined, the entity sources have no main program and are linked into the generator instead
+ *  (see the <tt>threaded</tt> target of the Makefile): the pilot, the hostess and the passengers run as threads of a
+ *  single process, sharing the region and the semaphore set it created. Before creating the threads, the
+ *  generator binds every entity type to them and opens the only log session; the entities neither connect to the
+ *  region and the set nor open a log session of their own.
+ *
+ *  When also compiled with <tt>SEM_CORO</tt> defined (see the <tt>coro</tt> target of the Makefile), the entities are
+ *  coroutines run by a single thread instead (see <tt>coroutine.h</tt>): their semaphores are queues of coroutines
+ *  (see <tt>semaphoreCoro.c</tt>) and their calls to <tt>usleep</tt> are replaced by <tt>coSleep</tt>, so that a
+ *  travelling passenger or a flying pilot suspends itself instead of the thread.
+ *
+ *  The records kept by a process in the deferred logging build cannot be shared by threads, so that build is not
+ *  supported. Neither are the semaphore statistics of the coroutine build: the time a coroutine waits is spent
+ *  running the others.
+ */
+
+#ifndef ENTITYTHREADS_H_
+#define ENTITYTHREADS_H_
+
+#include "sharedDataSync.h"
+
+#if defined (THREADED) && defined (LOG_DEFERRED)
+#error "the threaded build does not support deferred logging"
+#endif
+
+#ifdef SEM_CORO
+
+#if defined (SEM_STATS)
+#error "the coroutine build does not support the semaphore statistics"
+#endif
+
+#include "coroutine.h"
+
+/** \brief sleeping suspends the running coroutine only (coroutine build) */
+#define  usleep(usec)                      coSleep (usec)
+
+#endif /* SEM_CORO */
+
+/**
+ *  \brief Life cycle of the pilot.
+ */
+
+extern void pilotLife (void);
+
+/**
+ *  \brief Life cycle of the hostess.
+ */
+
+extern void hostessLife (void);
+
+/**
+ *  \brief Life cycle of a passenger.
+ *
+ *  \param passengerId passenger id
+ */
+
+extern void passengerLife (unsigned int passengerId);
+
+#ifdef THREADED
+
+/**
+ *  \brief Binding the pilot to the region and the semaphore set of the generator (threaded build).
+ *
+ *  \param logName name of the logging file
+ *  \param sgid semaphore set access identifier
+ *  \param shared pointer to the shared region
+ */
+
+extern void pilotBind (char logName[], int sgid, SHARED_DATA *shared);
+
+/**
+ *  \brief Binding the hostess to the region and the semaphore set of the generator (threaded build).
+ *
+ *  \param logName name of the logging file
+ *  \param sgid semaphore set access identifier
+ *  \param shared pointer to the shared region
+ */
+
+extern void hostessBind (char logName[], int sgid, SHARED_DATA *shared);
+
+/**
+ *  \brief Binding the passengers to the region and the semaphore set of the generator (threaded build).
+ *
+ *  The logging level must have been set.
+ *
+ *  \param logName name of the logging file
+ *  \param sgid semaphore set access identifier
+ *  \param shared pointer to the shared region
+ */
+
+extern void passengerBind (char logName[], int sgid, SHARED_DATA *shared);
+
+#endif /* THREADED */
+
+#endif /* ENTITYTHREADS_H_ */
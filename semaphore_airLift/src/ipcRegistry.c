@@ -0,0 +1,225 @@
+/**
+ *  \file ipcRegistry.c (implementation file)
+ *
+ *  \brief Problem name: Air Lift.
+ *
+ *  \brief Registry of the access keys in use.
+ *
+ *  The registry file is locked with a <tt>fcntl</tt> write lock, read whole into a table, changed and rewritten
+ *  before the lock is released.
+ */
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/types.h>
+
+#include "ipcRegistry.h"
+#include "semaphore.h"
+#include "sharedMemory.h"
+
+/** \brief access permission of the registry file: user r-w */
+#define  MASK           0600
+
+/**
+ *  \brief Definition of <em>registry entry</em> data type.
+ */
+typedef struct
+        { /** \brief access key */
+          int key;
+          /** \brief process identifier of the owner */
+          pid_t owner;
+
+        } REG_ENTRY;
+
+/**
+ *  \brief Opening and locking the registry file and reading its entries.
+ *
+ *  \param path name of the registry file (created, if absent)
+ *  \param tab table where the entries are stored (<tt>IPCREGMAX</tt> entries)
+ *  \param pN pointer to the location where the number of entries is stored
+ *
+ *  \return stream of the file, locked, upon success
+ *  \return NULL, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+static FILE *regOpen (const char *path, REG_ENTRY tab[], unsigned int *pN)
+{
+    struct flock lk = { .l_type = F_WRLCK, .l_whence = SEEK_SET, .l_start = 0, .l_len = 0 };      /* whole file */
+    unsigned int key;
+    int fd, owner;
+    FILE *fp;
+
+    if ((fd = open (path, O_RDWR | O_CREAT, MASK)) == -1) {
+        return NULL;
+    }
+    while (fcntl (fd, F_SETLKW, &lk) == -1) {
+        if (errno != EINTR) {
+            close (fd);
+            return NULL;
+        }
+    }
+    if ((fp = fdopen (fd, "r+")) == NULL) {
+        close (fd);                                                                         /* the lock goes with it */
+        return NULL;
+    }
+    *pN = 0;
+    while ((*pN < IPCREGMAX) && (fscanf (fp, "%x %d", &key, &owner) == 2)) {
+        tab[*pN].key = (int) key;
+        tab[*pN].owner = (pid_t) owner;
+        *pN += 1;
+    }
+    return fp;
+}
+
+/**
+ *  \brief Rewriting the entries of the registry file, unlocking and closing it.
+ *
+ *  \param fp stream of the file
+ *  \param tab table of the entries
+ *  \param n number of entries
+ *
+ *  \return \c 0, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+static int regClose (FILE *fp, const REG_ENTRY tab[], unsigned int n)
+{
+    unsigned int e;
+    int stat = 0;
+
+    rewind (fp);
+    for (e = 0; e < n; e++) {
+        fprintf (fp, "0x%08x %d\n", (unsigned int) tab[e].key, (int) tab[e].owner);
+    }
+    if ((fflush (fp) == EOF) || (ftruncate (fileno (fp), ftell (fp)) == -1)) {
+        stat = -1;
+    }
+    if ((fclose (fp) == EOF) && (stat == 0)) {                                        /* the lock is released */
+        stat = -1;
+    }
+    return stat;
+}
+
+/**
+ *  \brief Testing if the owner of an entry is alive.
+ *
+ *  An entry of the calling process was left by an earlier process with the same identifier. A process that has
+ *  terminated but was not waited for yet (its state in <tt>/proc</tt> is <tt>Z</tt>) is no longer alive.
+ *
+ *  \param owner process identifier of the owner
+ *
+ *  \return \c true, if it is alive
+ */
+
+static bool alive (pid_t owner)
+{
+    char name[32], line[256], *st;
+    FILE *fp;
+    bool zombie = false;
+
+    if ((owner <= 0) || (owner == getpid ())) {
+        return false;
+    }
+    if ((kill (owner, 0) == -1) && (errno != EPERM)) {
+        return false;
+    }
+    sprintf (name, "/proc/%d/stat", (int) owner);
+    if ((fp = fopen (name, "r")) != NULL) {               /* pid (command) state ..., the command may hold ')' */
+        if ((fgets (line, sizeof (line), fp) != NULL) && ((st = strrchr (line, ')')) != NULL)) {
+            zombie = (st[1] == ' ') && (st[2] == 'Z');
+        }
+        fclose (fp);
+    }
+    return !zombie;
+}
+
+/**
+ *  \brief Getting a free key, reclaiming the resources of the owners that are no longer alive.
+ *
+ *  \param path name of the registry file (created, if absent)
+ *  \param keys candidate keys, in order of preference
+ *  \param nKeys number of candidate keys
+ *  \param pKey pointer to the location where the key taken is stored
+ *
+ *  \return number of owners whose resources were reclaimed, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+int ipcRegAcquire (const char *path, const int keys[], unsigned int nKeys, int *pKey)
+{
+    REG_ENTRY tab[IPCREGMAX];
+    unsigned int n, e, k, kept = 0;
+    int nReclaimed = 0;
+    FILE *fp;
+
+    if ((fp = regOpen (path, tab, &n)) == NULL) {
+        return -1;
+    }
+
+    /* dropping the entries of the owners no longer alive, after destroying what they left behind */
+
+    for (e = 0; e < n; e++) {
+        if (alive (tab[e].owner)) {
+            tab[kept++] = tab[e];
+            continue;
+        }
+        semReclaim (tab[e].key);                                              /* ENOENT, if nothing was left behind */
+        shmemReclaim (tab[e].key);
+        nReclaimed += 1;
+    }
+    n = kept;
+
+    /* taking the first candidate owned by no one */
+
+    for (k = 0; k < nKeys; k++) {
+        for (e = 0; (e < n) && (tab[e].key != keys[k]); e++) {
+        }
+        if (e == n) {
+            break;
+        }
+    }
+    if ((k == nKeys) || (n == IPCREGMAX)) {
+        regClose (fp, tab, n);
+        errno = EBUSY;
+        return -1;
+    }
+    tab[n].key = keys[k];
+    tab[n].owner = getpid ();
+    if (regClose (fp, tab, n + 1) == -1) {
+        return -1;
+    }
+    *pKey = keys[k];
+    return nReclaimed;
+}
+
+/**
+ *  \brief Giving a key back.
+ *
+ *  \param path name of the registry file
+ *  \param key key
+ *
+ *  \return \c 0, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+int ipcRegRelease (const char *path, int key)
+{
+    REG_ENTRY tab[IPCREGMAX];
+    unsigned int n, e, kept = 0;
+    FILE *fp;
+
+    if ((fp = regOpen (path, tab, &n)) == NULL) {
+        return -1;
+    }
+    for (e = 0; e < n; e++) {
+        if ((tab[e].key != key) || (tab[e].owner != getpid ())) {
+            tab[kept++] = tab[e];
+        }
+    }
+    return regClose (fp, tab, kept);
+}
@@ -0,0 +1,64 @@
+/**
+ *  \file ipcRegistry.h (interface file)
+ *
+ *  \brief Problem name: Air Lift.
+ *
+ *  \brief Registry of the access keys in use.
+ *
+ *  The access keys to the shared region and the semaphore set are handed out by a registry kept in a text file,
+ *  one line per key, with the key (in hexadecimal) and the process identifier of its owner, the generator that
+ *  created the resources. The file is locked while it is read and rewritten, so generators started at the same
+ *  time get different keys; the lock is released by the system if the holder terminates.
+ *
+ *  Whenever a key is asked for, the entries whose owner is no longer alive are dropped and the semaphore set and
+ *  the shared region left behind with their key, if any, are destroyed (see <tt>semReclaim</tt> and
+ *  <tt>shmemReclaim</tt>): a run that crashed does not prevent the next one from starting. The resources created
+ *  with a key that was not handed out by the registry are not known to it.
+ *
+ *  Defined operations:
+ *     \li getting a free key, reclaiming the resources of the owners that are no longer alive
+ *     \li giving a key back.
+ */
+
+#ifndef IPCREGISTRY_H_
+#define IPCREGISTRY_H_
+
+/** \brief name of the registry file (in the working directory) */
+#define  IPCREGFILE      "airlift.lock"
+
+/** \brief largest number of entries of the registry */
+#define  IPCREGMAX       256
+
+/**
+ *  \brief Getting a free key, reclaiming the resources of the owners that are no longer alive.
+ *
+ *  The first of the candidate keys that is not owned by a process alive is taken and recorded with the calling
+ *  process as its owner.
+ *  The function fails with <tt>EBUSY</tt> if every candidate is owned by a process alive.
+ *
+ *  \param path name of the registry file (created, if absent)
+ *  \param keys candidate keys, in order of preference
+ *  \param nKeys number of candidate keys
+ *  \param pKey pointer to the location where the key taken is stored
+ *
+ *  \return number of owners whose resources were reclaimed, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+extern int ipcRegAcquire (const char *path, const int keys[], unsigned int nKeys, int *pKey);
+
+/**
+ *  \brief Giving a key back.
+ *
+ *  The entry of the key owned by the calling process is dropped; its resources must have been destroyed.
+ *
+ *  \param path name of the registry file
+ *  \param key key
+ *
+ *  \return \c 0, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+extern int ipcRegRelease (const char *path, int key);
+
+#endif /* IPCREGISTRY_H_ */
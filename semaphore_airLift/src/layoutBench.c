@@ -0,0 +1,167 @@
+/**
+ *  \file layoutBench.c (implementation file)
+ *
+ *  \brief Problem name: Air Lift.
+ *
+ *  Benchmark of the layouts of the full state of the problem.
+ *
+ *  The same source is built once with the packed layout and once with the padded one (<tt>LAYOUT_PADDED</tt>; see
+ *  <tt>probDataStruct.h</tt>, the <tt>bench</tt> target of the Makefile and <tt>layoutBench.sh</tt>), with many
+ *  passengers. A pilot, a hostess and several passenger processes keep writing the fields of <tt>FULL_STAT</tt>
+ *  they update in the simulation, at the same time and without mutual exclusion, so that the cost of moving cache
+ *  lines among the CPUs is all that is measured:
+ *    \li the pilot: its state and the flight number
+ *    \li the hostess: its state and the counters of passengers in flight and boarded
+ *    \li passenger process <tt>k</tt>: the states of the <tt>k</tt>-th group of passengers (a cache line of them
+ *        in the padded layout).
+ *
+ *  On a single CPU the processes never run at the same time and both layouts take the same time.
+ *
+ *  Upon execution, the following parameters are accepted:
+ *    \li <tt>-n iterations</tt>: number of writes of every process (10000000, by default)
+ *    \li <tt>-p processes</tt>: number of passenger processes (4, by default).
+ *
+ *  The mean time of a write is written to stdout.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/types.h>
+#include <sys/ipc.h>
+#include <sys/wait.h>
+
+#include "probConst.h"
+#include "probDataStruct.h"
+#include "sharedMemory.h"
+
+/** \brief name of the layout */
+#ifdef LAYOUT_PADDED
+#define  LAYOUT         "padded"
+#else
+#define  LAYOUT         "packed"
+#endif
+
+/** \brief number of passengers in a group (the states that fit in a cache line) */
+#define  GROUP          (CACHELINE / sizeof (unsigned int))
+
+/**
+ *  \brief Getting the present time in ns.
+ */
+
+static double now (void)
+{
+    struct timespec t;
+
+    clock_gettime (CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1e9 + t.tv_nsec;
+}
+
+/**
+ *  \brief Carrying out an operation, aborting the benchmark if it fails.
+ */
+
+static void check (int stat, const char *msg)
+{
+    if (stat == -1) {
+        perror (msg);
+        exit (EXIT_FAILURE);
+    }
+}
+
+/**
+ *  \brief Life cycle of a writing process.
+ *
+ *  \param fSt pointer to the full state of the problem
+ *  \param who -2 for the pilot, -1 for the hostess, the group number for a passenger process
+ *  \param n number of writes
+ */
+
+static void writer (volatile FULL_STAT *fSt, long who, long n)
+{
+    long i;
+
+    for (i = 0; i < n; i++) {
+        switch (who) {
+        case -2:
+            fSt->st.pilotStat = (unsigned int) i;
+            fSt->nFlight = (unsigned int) i;
+            break;
+        case -1:
+            fSt->st.hostessStat = (unsigned int) i;
+            fSt->nPassInFlight = (unsigned int) i;
+            fSt->totalPassBoarded = (unsigned int) i;
+            break;
+        default:
+            fSt->st.passengerStat[who * GROUP + i % GROUP] = (unsigned int) i;
+        }
+    }
+    exit (EXIT_SUCCESS);
+}
+
+/**
+ *  \brief Main program.
+ *
+ *  Its role is creating the shared region, launching the writing processes and timing them.
+ */
+
+int main (int argc, char *argv[])
+{
+    long n = 10000000;                                                                            /* number of writes */
+    long nPass = 4, p;                                                               /* number of passenger processes */
+    int key, shmid, status;
+    FULL_STAT *fSt;
+    double t0;
+    char *tinp;
+    int opt;
+
+    while ((opt = getopt (argc, argv, "n:p:")) != -1) {
+        switch (opt) {
+        case 'n':
+            n = strtol (optarg, &tinp, 0);
+            break;
+        case 'p':
+            nPass = strtol (optarg, &tinp, 0);
+            break;
+        default:
+            fprintf (stderr, "Usage: %s [-n iterations] [-p processes]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+        if ((*tinp != '\0') || (n < 1) || (nPass < 1) || (nPass * GROUP > N)) {
+            fprintf (stderr, "Invalid option value!\n");
+            return EXIT_FAILURE;
+        }
+    }
+
+    if ((key = ftok (".", 'd')) == -1) {
+        perror ("error on generating the key");
+        return EXIT_FAILURE;
+    }
+    check (shmid = shmemCreate (key, sizeof (FULL_STAT)), "error on creating the shared memory region");
+    check (shmemAttach (shmid, (void **) &fSt), "error on mapping the shared region");
+
+    t0 = now ();
+    for (p = -2; p < nPass; p++) {
+        switch (fork ()) {
+        case -1:
+            check (-1, "error on the fork operation");
+            break;
+        case 0:
+            writer (fSt, p, n);
+        }
+    }
+    for (p = -2; p < nPass; p++) {
+        if ((wait (&status) == -1) || !WIFEXITED (status) || (WEXITSTATUS (status) != EXIT_SUCCESS)) {
+            fprintf (stderr, "A writing process failed!\n");
+            return EXIT_FAILURE;
+        }
+    }
+    printf ("%-6s %5zu bytes, %ld processes %10.2f ns/write\n", LAYOUT, sizeof (FULL_STAT), nPass + 2,
+            (now () - t0) / (double) (n * (nPass + 2)));
+
+    check (shmemDettach (fSt), "error on unmapping the shared region");
+    check (shmemDestroy (shmid), "error on destructing the shared region");
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,513 @@
+/**
+ *  \file logCheck.c (implementation file)
+ *
+ *  \brief Problem name: Air Lift.
+ *
+ *  Invariant checker of text logging files.
+ *
+ *  The lines of the log are read through <tt>logReader</tt> (so any number of passengers and both the full and the
+ *  delta formats are accepted) and the following rules are checked for every run:
+ *    \li passengers in queue + passengers in flight + passengers at destination = passengers that have arrived at
+ *        the airport
+ *    \li the state of every entity only changes according to its life cycle (see <tt>probConst.h</tt>)
+ *    \li the number of passengers of every flight is within <tt>MINFC</tt> and <tt>MAXFC</tt>, except for a final
+ *        shorter flight when all passengers have boarded, and equals the number of passengers checked
+ *    \li at the end of the run, all passengers have boarded and the summary agrees with the flights.
+ *
+ *  Upon execution, the following parameters are accepted:
+ *    \li <tt>-j n</tt>: number of processes checking files in parallel (number of online processors, by default)
+ *    \li names of logging files or of directories whose regular files are logging files (stdin, if absent).
+ *
+ *  The violations found are printed to stdout (at most <tt>MAXREPORT</tt> per file), followed by a summary.
+ *  The exit status is \c EXIT_FAILURE if any violation was found.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdarg.h>
+#include <string.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+
+#include "probConst.h"
+#include "logReader.h"
+
+/** \brief maximum number of violations reported per file */
+#define  MAXREPORT         10
+
+/** \brief maximum size of the report of a violation */
+#define  REPORTLEN        160
+
+/**
+ *  \brief Definition of <em>result of checking a file</em> data type.
+ *
+ *  The results are kept in memory shared by all the checking processes.
+ */
+typedef struct
+{ /** \brief the file could not be read */
+    bool failed;
+    /** \brief number of lines */
+    unsigned long nLines;
+    /** \brief number of runs */
+    unsigned long nRuns;
+    /** \brief number of flights */
+    unsigned long nFlights;
+    /** \brief number of violations */
+    unsigned long nViolations;
+    /** \brief reports of the first violations */
+    char report[MAXREPORT][REPORTLEN];
+
+} CHECK_RESULT;
+
+/**
+ *  \brief Definition of <em>state of the checker</em> data type.
+ */
+typedef struct
+{ /** \brief result of the file being checked */
+    CHECK_RESULT *res;
+    /** \brief number of passengers of the run (from the header) */
+    int n;
+    /** \brief entity states in the previous line of state: pilot, hostess and passengers */
+    int *prev;
+    /** \brief there was a line of state since the start of the run */
+    bool known;
+    /** \brief counters in the previous line of state */
+    int cnt[NCOUNTERS];
+    /** \brief a flight is boarding or flying */
+    bool inFlight;
+    /** \brief flight number */
+    int flight;
+    /** \brief number of passengers checked in the current flight */
+    int nChecked;
+    /** \brief number of passengers checked in the run */
+    int nBoarded;
+    /** \brief a run is in progress */
+    bool inRun;
+    /** \brief number of flights that departed */
+    int nDeparted;
+    /** \brief sum of the passengers of the flights in the summary */
+    int nTook;
+    /** \brief a summary was found */
+    bool result;
+
+} CHECKER;
+
+/** \brief legal transitions of the pilot state: pilotNext[s] is the state that may follow s */
+static const int pilotNext[] = { READY_FOR_BOARDING, WAITING_FOR_BOARDING, FLYING, DROPING_PASSENGERS, FLYING_BACK };
+
+/** \brief names of the pilot states */
+static const char *pilotName[] = { "FLYING_BACK", "READY_FOR_BOARDING", "WAITING_FOR_BOARDING", "FLYING",
+                                   "DROPING_PASSENGERS" };
+
+/** \brief names of the hostess states */
+static const char *hostessName[] = { "WAIT_FOR_FLIGHT", "WAIT_FOR_PASSENGER", "CHECK_PASSPORT", "READY_TO_FLIGHT" };
+
+/** \brief names of the passenger states */
+static const char *passengerName[] = { "GOING_TO_AIRPORT", "IN_QUEUE", "IN_FLIGHT", "AT_DESTINATION" };
+
+/**
+ *  \brief Reporting a violation.
+ *
+ *  \param ck pointer to the checker
+ *  \param lineNo line where the violation was found
+ *  \param fmt format of the report (as in printf)
+ */
+
+static void violation (CHECKER *ck, unsigned long lineNo, const char *fmt, ...)
+{
+    va_list ap;
+    int len;
+
+    if (ck->res->nViolations < MAXREPORT) {
+        char *rep = ck->res->report[ck->res->nViolations];
+
+        len = snprintf (rep, REPORTLEN, "line %lu: ", lineNo);
+        va_start (ap, fmt);
+        vsnprintf (rep + len, (size_t) (REPORTLEN - len), fmt, ap);
+        va_end (ap);
+    }
+    ck->res->nViolations += 1;
+}
+
+/**
+ *  \brief Name of a state.
+ *
+ *  \param names names of the states
+ *  \param nStates number of states
+ *  \param s state
+ *
+ *  \return name of the state, or "?" if it is out of range
+ */
+
+static const char *stateName (const char *names[], int nStates, int s)
+{
+    return ((s >= 0) && (s < nStates)) ? names[s] : "?";
+}
+
+/**
+ *  \brief Checking the transition of the state of an entity.
+ *
+ *  \param e entity (0 - pilot, 1 - hostess, 2.. - passengers)
+ *  \param from previous state
+ *  \param to new state
+ *
+ *  \return \c true, if the transition is legal
+ */
+
+static bool legalTransition (int e, int from, int to)
+{
+    if (from == to) {
+        return true;
+    }
+    switch (e) {
+    case 0:
+        return (from >= FLYING_BACK) && (from <= DROPING_PASSENGERS) && (to == pilotNext[from]);
+    case 1:
+        return ((from == WAIT_FOR_FLIGHT) && (to == WAIT_FOR_PASSENGER)) ||
+               ((from == WAIT_FOR_PASSENGER) && (to == CHECK_PASSPORT)) ||
+               ((from == CHECK_PASSPORT) && ((to == WAIT_FOR_PASSENGER) || (to == READY_TO_FLIGHT))) ||
+               ((from == READY_TO_FLIGHT) && (to == WAIT_FOR_FLIGHT));
+    default:
+        return (from >= GOING_TO_AIRPORT) && (from < AT_DESTINATION) && (to == from + 1);
+    }
+}
+
+/**
+ *  \brief Checking a line of state.
+ *
+ *  \param ck pointer to the checker
+ *  \param line pointer to the line of state
+ */
+
+static void checkState (CHECKER *ck, const LOG_LINE *line)
+{
+    int e, arrived = 0, atDest = 0;
+
+    for (e = 0; e < ck->n + 2; e++) {
+        int from = ck->known ? ck->prev[e] : 0;                                 /* every entity starts at state 0 */
+        int to = line->stat[e];
+
+        if (!legalTransition (e, from, to)) {
+            if (e == 0) {
+                violation (ck, line->lineNo, "pilot %s -> %s", stateName (pilotName, 5, from),
+                           stateName (pilotName, 5, to));
+            }
+            else if (e == 1) {
+                violation (ck, line->lineNo, "hostess %s -> %s", stateName (hostessName, 4, from),
+                           stateName (hostessName, 4, to));
+            }
+            else violation (ck, line->lineNo, "passenger %d %s -> %s", e - 2, stateName (passengerName, 4, from),
+                            stateName (passengerName, 4, to));
+        }
+        if (e >= 2) {
+            if (to != GOING_TO_AIRPORT) {
+                arrived += 1;
+            }
+            if (to == AT_DESTINATION) {
+                atDest += 1;
+            }
+        }
+        ck->prev[e] = to;
+    }
+    if (line->cnt[0] + line->cnt[1] + atDest != arrived) {
+        violation (ck, line->lineNo, "InQ %d + InF %d + at destination %d != arrived at the airport %d",
+                   line->cnt[0], line->cnt[1], atDest, arrived);
+    }
+    if ((line->cnt[1] > MAXFC) || (line->cnt[2] > ck->n)) {
+        violation (ck, line->lineNo, "InF %d or toB %d out of range", line->cnt[1], line->cnt[2]);
+    }
+    memcpy (ck->cnt, line->cnt, sizeof (ck->cnt));
+    ck->known = true;
+}
+
+/**
+ *  \brief Checking the end of a run.
+ *
+ *  \param ck pointer to the checker
+ *  \param lineNo line where the run ends
+ */
+
+static void endRun (CHECKER *ck, unsigned long lineNo)
+{
+    if (!ck->inRun) {
+        return;
+    }
+    if (ck->known && (ck->cnt[2] != ck->n)) {                       /* the lines of state may not have been logged */
+        violation (ck, lineNo, "run ended with %d of %d passengers boarded", ck->cnt[2], ck->n);
+    }
+    if ((ck->nDeparted > 0) && (ck->nBoarded != ck->n)) {             /* nor the flight events (logging level) */
+        violation (ck, lineNo, "run ended with %d of %d passengers checked", ck->nBoarded, ck->n);
+    }
+    if (ck->result && (ck->nTook != ck->n)) {
+        violation (ck, lineNo, "summary accounts for %d of %d passengers", ck->nTook, ck->n);
+    }
+    ck->known = false;
+    ck->inRun = false;
+}
+
+/**
+ *  \brief Checking a line.
+ *
+ *  \param ck pointer to the checker
+ *  \param lr pointer to the reader
+ *  \param line pointer to the line
+ */
+
+static void checkLine (CHECKER *ck, const LOG_READER *lr, const LOG_LINE *line)
+{
+    switch (line->kind) {
+    case LINE_TITLE:
+        endRun (ck, line->lineNo);
+        ck->res->nRuns += 1;
+        ck->inFlight = false;
+        ck->nDeparted = ck->nTook = ck->nBoarded = 0;
+        ck->inRun = true;
+        ck->result = false;
+        memset (ck->cnt, 0, sizeof (ck->cnt));
+        break;
+    case LINE_HEADER:
+        if (lr->nEnt - 2 != ck->n) {
+            free (ck->prev);
+            if ((ck->prev = calloc ((size_t) lr->nEnt, sizeof (int))) == NULL) {
+                perror ("error on allocating the previous state");
+                exit (EXIT_FAILURE);
+            }
+            ck->n = lr->nEnt - 2;
+            ck->known = false;
+        }
+        break;
+    case LINE_STATE:
+        checkState (ck, line);
+        break;
+    case LINE_BOARDING:
+        if (ck->inFlight) {
+            violation (ck, line->lineNo, "flight %d started while flight %d was not over", line->flight, ck->flight);
+        }
+        ck->inFlight = true;
+        ck->flight = line->flight;
+        ck->nChecked = 0;
+        break;
+    case LINE_CHECKED:
+        ck->nChecked += 1;
+        ck->nBoarded += 1;
+        if ((ck->n < 0) || (line->value >= ck->n) || (ck->known &&
+            (ck->prev[line->value + 2] != IN_QUEUE) && (ck->prev[line->value + 2] != IN_FLIGHT))) {
+            violation (ck, line->lineNo, "passenger %d checked while not boarding", line->value);
+        }
+        break;
+    case LINE_DEPARTED:
+        ck->res->nFlights += 1;
+        ck->nDeparted += 1;
+        if ((line->value > MAXFC) || (line->value < 1) || ((line->value < MINFC) && (ck->nBoarded != ck->n))) {
+            violation (ck, line->lineNo, "flight %d departed with %d passengers (%d boarded)", line->flight,
+                       line->value, ck->nBoarded);
+        }
+        if (line->value != ck->nChecked) {
+            violation (ck, line->lineNo, "flight %d departed with %d passengers, but %d were checked", line->flight,
+                       line->value, ck->nChecked);
+        }
+        break;
+    case LINE_RETURNING:
+        ck->inFlight = false;
+        break;
+    case LINE_RESULT:
+        ck->result = true;
+        ck->inFlight = false;
+        break;
+    case LINE_USED:
+        if ((ck->nDeparted > 0) && (line->value != ck->nDeparted)) {             /* flight events may be off */
+            violation (ck, line->lineNo, "summary reports %d flights, %d departed", line->value, ck->nDeparted);
+        }
+        break;
+    case LINE_TOOK:
+        ck->nTook += line->value;
+        break;
+    }
+}
+
+/**
+ *  \brief Checking a logging file.
+ *
+ *  \param nFic name of the logging file (stdin, if NULL)
+ *  \param res pointer to the location where the result is stored
+ */
+
+static void checkFile (const char *nFic, CHECK_RESULT *res)
+{
+    LOG_READER lr;
+    LOG_LINE line;
+    CHECKER ck;
+
+    memset (res, 0, sizeof (CHECK_RESULT));
+    if (logReaderOpen (&lr, nFic) == -1) {
+        res->failed = true;
+        return;
+    }
+    memset (&ck, 0, sizeof (ck));
+    ck.res = res;
+    ck.n = -1;
+    while (logReaderNext (&lr, &line)) {
+        checkLine (&ck, &lr, &line);
+        res->nLines += 1;
+    }
+    endRun (&ck, res->nLines);
+    free (ck.prev);
+    logReaderClose (&lr);
+}
+
+/**
+ *  \brief Adding a file name to a list.
+ *
+ *  \param list pointer to the list
+ *  \param n pointer to the number of names in the list
+ *  \param name file name
+ */
+
+static void addName (char ***list, size_t *n, const char *name)
+{
+    if ((*list = realloc (*list, (*n + 1) * sizeof (char *))) == NULL || ((*list)[*n] = strdup (name)) == NULL) {
+        perror ("error on allocating the file list");
+        exit (EXIT_FAILURE);
+    }
+    *n += 1;
+}
+
+/**
+ *  \brief Comparison of two file names (for qsort).
+ */
+
+static int cmpName (const void *a, const void *b)
+{
+    return strcmp (*(char * const *) a, *(char * const *) b);
+}
+
+/**
+ *  \brief Main program.
+ *
+ *  Its role is building the list of files, launching the checking processes and printing the results.
+ *  The files are handed out to the processes through a shared counter, so a slow file does not hold the others.
+ */
+
+int main (int argc, char *argv[])
+{
+    char **name = NULL;                                                                      /* files to be checked */
+    size_t nFiles = 0, f;
+    long nProc = sysconf (_SC_NPROCESSORS_ONLN);                                          /* number of processes */
+    CHECK_RESULT *res;                                                                  /* results (shared memory) */
+    size_t *next;                                                          /* next file to be checked (shared memory) */
+    unsigned long nLines = 0, nRuns = 0, nFlights = 0, nViolations = 0, nBad = 0;
+    int opt, p, r;
+    char *tinp;
+
+    while ((opt = getopt (argc, argv, "j:")) != -1) {
+        switch (opt) {
+        case 'j':
+            nProc = strtol (optarg, &tinp, 0);
+            if ((*tinp != '\0') || (nProc < 1)) {
+                fprintf (stderr, "Invalid number of processes!\n");
+                return EXIT_FAILURE;
+            }
+            break;
+        default:
+            fprintf (stderr, "Usage: %s [-j processes] [log file | directory] ...\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    for (; optind < argc; optind++) {
+        struct stat st;
+
+        if ((stat (argv[optind], &st) == 0) && S_ISDIR (st.st_mode)) {
+            DIR *dir;
+            struct dirent *ent;
+            size_t first = nFiles;
+            char path[4096];
+
+            if ((dir = opendir (argv[optind])) == NULL) {
+                perror ("error on opening the directory");
+                return EXIT_FAILURE;
+            }
+            while ((ent = readdir (dir)) != NULL) {
+                snprintf (path, sizeof (path), "%s/%s", argv[optind], ent->d_name);
+                if ((stat (path, &st) == 0) && S_ISREG (st.st_mode)) {
+                    addName (&name, &nFiles, path);
+                }
+            }
+            closedir (dir);
+            qsort (name + first, nFiles - first, sizeof (char *), cmpName);
+        }
+        else addName (&name, &nFiles, argv[optind]);
+    }
+    if (nFiles == 0) {
+        addName (&name, &nFiles, "-");
+    }
+    if ((size_t) nProc > nFiles) {
+        nProc = (long) nFiles;
+    }
+
+    res = mmap (NULL, nFiles * sizeof (CHECK_RESULT) + sizeof (size_t), PROT_READ | PROT_WRITE,
+                MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (res == MAP_FAILED) {
+        perror ("error on mapping the results");
+        return EXIT_FAILURE;
+    }
+    next = (size_t *) (res + nFiles);
+
+    if (nProc == 1) {
+        for (f = 0; f < nFiles; f++) {
+            checkFile (name[f], &res[f]);
+        }
+    }
+    else {
+        for (p = 0; p < nProc; p++) {
+            switch (fork ()) {
+            case -1:
+                perror ("error on the fork operation for a checking process");
+                return EXIT_FAILURE;
+            case 0:
+                while ((f = __atomic_fetch_add (next, 1, __ATOMIC_RELAXED)) < nFiles) {
+                    checkFile (name[f], &res[f]);
+                }
+                exit (EXIT_SUCCESS);
+            }
+        }
+        for (p = 0; p < nProc; p++) {
+            if ((wait (&r) == -1) || !WIFEXITED (r) || (WEXITSTATUS (r) != EXIT_SUCCESS)) {
+                fprintf (stderr, "A checking process failed!\n");
+                return EXIT_FAILURE;
+            }
+        }
+    }
+
+    for (f = 0; f < nFiles; f++) {
+        if (res[f].failed) {
+            printf ("%s: could not be read\n", name[f]);
+            nBad += 1;
+            continue;
+        }
+        if (res[f].nViolations > 0) {
+            unsigned long v;
+
+            for (v = 0; (v < res[f].nViolations) && (v < MAXREPORT); v++) {
+                printf ("%s: %s\n", name[f], res[f].report[v]);
+            }
+            if (res[f].nViolations > MAXREPORT) {
+                printf ("%s: ... %lu more violations\n", name[f], res[f].nViolations - MAXREPORT);
+            }
+            nBad += 1;
+        }
+        nLines += res[f].nLines;
+        nRuns += res[f].nRuns;
+        nFlights += res[f].nFlights;
+        nViolations += res[f].nViolations;
+    }
+    printf ("%zu files, %lu lines, %lu runs, %lu flights: %lu violations in %lu files\n", nFiles, nLines, nRuns,
+            nFlights, nViolations, nBad);
+
+    return (nBad == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,110 @@
+/**
+ *  \file logDecoder.c (implementation file)
+ *
+ *  \brief Problem name: Air Lift.
+ *
+ *  Decoder of the binary logging file.
+ *
+ *  Rebuilds the text log from the event records written by a <tt>LOG_BINARY</tt> build of the simulation.
+ *
+ *  Upon execution, the following parameters are accepted:
+ *    \li <tt>-t</tt>: precede every line of state with the time stamp of the event (in us, since the first event)
+ *    \li <tt>-d</tt>: print the lines of state in the delta format ("." for the entities whose state did not change)
+ *    \li name of the binary logging file (stdin, if absent).
+ *
+ *  The text log is written to stdout.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "probConst.h"
+#include "probDataStruct.h"
+#include "logging.h"
+
+/** \brief number of event records read at once */
+#define  NRECREAD      1024
+
+/**
+ *  \brief Main program.
+ *
+ *  Its role is reading the event records of the binary logging file and printing them in text format.
+ */
+
+int main (int argc, char *argv[])
+{
+    FILE *fic;                                                                                      /* file descriptor */
+    LOG_FILE_HDR hdr;                                                                           /* binary file header */
+    static LOG_REC rec[NRECREAD];                                                                    /* event records */
+    size_t nRec, r;                                                                              /* counting variables */
+    bool timed = false;                                                                        /* print time stamps */
+    bool delta = false;                                                                   /* print in delta format */
+    unsigned char last[N+2];                                        /* packed state in the previous line of state */
+    unsigned long long t0 = 0;                                                              /* time of the first event */
+    bool first = true;
+    int opt;
+
+    while ((opt = getopt (argc, argv, "td")) != -1) {
+        switch (opt) {
+        case 't':
+            timed = true;
+            break;
+        case 'd':
+            delta = true;
+            break;
+        default:
+            fprintf (stderr, "Usage: %s [-t] [-d] [binary log file]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (optind < argc) {
+        if ((fic = fopen (argv[optind], "r")) == NULL) {
+            perror ("error on opening the binary log file");
+            return EXIT_FAILURE;
+        }
+    }
+    else fic = stdin;
+
+    if (fread (&hdr, sizeof (hdr), 1, fic) != 1) {
+        fprintf (stderr, "The binary log file is empty!\n");
+        return EXIT_FAILURE;
+    }
+    if (strncmp (hdr.magic, LOGMAGIC, sizeof (hdr.magic)) != 0) {
+        fprintf (stderr, "This is not a binary log file!\n");
+        return EXIT_FAILURE;
+    }
+    if ((hdr.n != N) || (hdr.recSize != sizeof (LOG_REC))) {
+        fprintf (stderr, "The binary log file was written for %u passengers (this decoder handles %d)!\n", hdr.n, N);
+        return EXIT_FAILURE;
+    }
+
+    memset (last, LOG_UNCHANGED, sizeof (last));
+    printTitle (stdout);
+    while ((nRec = fread (rec, sizeof (LOG_REC), NRECREAD, fic)) > 0) {
+        for (r = 0; r < nRec; r++) {
+            if (first) {
+                t0 = rec[r].time;
+                first = false;
+            }
+            if (delta) {
+                markUnchanged (&rec[r], last);
+            }
+            if (timed && (rec[r].type == LOG_STATE)) {
+                printf ("%10llu ", (rec[r].time - t0) / 1000);
+            }
+            printRecord (stdout, &rec[r]);
+        }
+    }
+    if (ferror (fic)) {
+        perror ("error on reading the binary log file");
+        return EXIT_FAILURE;
+    }
+    if (fic != stdin) {
+        fclose (fic);
+    }
+
+    return EXIT_SUCCESS;
+}
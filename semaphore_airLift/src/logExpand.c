@@ -0,0 +1,154 @@
+/**
+ *  \file logExpand.c (implementation file)
+ *
+ *  \brief Problem name: Air Lift.
+ *
+ *  Expansion of a logging file written in the delta format.
+ *
+ *  Every "." in a line of state is replaced by the state the entity had in the previous line of state, so the
+ *  full format is restored. The number of passengers is taken from the header line (<tt>PT HT P00 ...</tt>),
+ *  so a log of any size is accepted. The other lines are copied unchanged.
+ *
+ *  Upon execution, one parameter is accepted:
+ *    \li name of the logging file (stdin, if absent).
+ *
+ *  The expanded log is written to stdout.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+
+/** \brief number of counters at the end of a line of state (waiting, flying, boarded) */
+#define  NCOUNTERS     3
+
+/**
+ *  \brief Splitting a line into blank separated fields.
+ *
+ *  The line is changed in place.
+ *
+ *  \param line line (without the newline)
+ *  \param field array where the location of the fields is stored
+ *  \param max size of the array
+ *
+ *  \return number of fields (<tt>max + 1</tt>, if there are more than <tt>max</tt>)
+ */
+
+static int splitFields (char *line, char *field[], int max)
+{
+    int n = 0;
+    char *tok;
+
+    for (tok = strtok (line, " \t"); tok != NULL; tok = strtok (NULL, " \t")) {
+        if (n == max) {
+            return max + 1;
+        }
+        field[n++] = tok;
+    }
+    return n;
+}
+
+/**
+ *  \brief Main program.
+ *
+ *  Its role is reading the log line by line and expanding the lines of state.
+ */
+
+int main (int argc, char *argv[])
+{
+    FILE *fic;                                                                                      /* file descriptor */
+    char *line = NULL,                                                                                  /* line read */
+         *copy = NULL;                                                                 /* line split into its fields */
+    size_t size = 0, copySize = 0;
+    ssize_t len;
+    char **field = NULL;                                                                 /* fields of a line of state */
+    char **prev = NULL;                                                   /* entity states in the previous line of state */
+    int nEnt = -1;                                                   /* number of entities (pilot, hostess, passengers) */
+    int nf, e;
+
+    if (argc > 2) {
+        fprintf (stderr, "Usage: %s [log file]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    if (argc == 2) {
+        if ((fic = fopen (argv[1], "r")) == NULL) {
+            perror ("error on opening the log file");
+            return EXIT_FAILURE;
+        }
+    }
+    else fic = stdin;
+
+    while ((len = getline (&line, &size, fic)) != -1) {
+        if ((size_t) len + 1 > copySize) {
+            copySize = (size_t) len + 1;
+            if ((copy = realloc (copy, copySize)) == NULL) {
+                perror ("error on allocating the line buffer");
+                return EXIT_FAILURE;
+            }
+        }
+        memcpy (copy, line, (size_t) len + 1);
+        if ((len > 0) && (copy[len-1] == '\n')) {
+            copy[len-1] = '\0';
+        }
+
+        if ((strncmp (copy, "PT", 2) == 0) || (strstr (copy, " PT ") != NULL)) {           /* header: get layout */
+            if (nEnt == -1) {
+                char *p;
+
+                for (nEnt = 0, p = copy; (p = strstr (p, " P")) != NULL; p++) {
+                    if ((p[2] >= '0') && (p[2] <= '9')) {
+                        nEnt += 1;                                                                 /* passenger */
+                    }
+                }
+                nEnt += 2;                                                                  /* pilot and hostess */
+                field = malloc ((size_t) (nEnt + NCOUNTERS) * sizeof (char *));
+                prev = calloc ((size_t) nEnt, sizeof (char *));
+                if ((field == NULL) || (prev == NULL)) {
+                    perror ("error on allocating the field table");
+                    return EXIT_FAILURE;
+                }
+            }
+            fputs (line, stdout);
+            continue;
+        }
+        if ((nEnt == -1) || ((nf = splitFields (copy, field, nEnt + NCOUNTERS)) != nEnt + NCOUNTERS) ||
+            (((field[0][0] < '0') || (field[0][0] > '9')) && (strcmp (field[0], ".") != 0))) {
+            fputs (line, stdout);                                                         /* not a line of state */
+            continue;
+        }
+
+        for (e = 0; e < nEnt; e++) {
+            if (strcmp (field[e], ".") == 0) {
+                if (prev[e] == NULL) {
+                    fprintf (stderr, "unchanged state without a previous value: %s", line);
+                    return EXIT_FAILURE;
+                }
+                field[e] = prev[e];
+            }
+            else {
+                free (prev[e]);
+                if ((prev[e] = strdup (field[e])) == NULL) {
+                    perror ("error on keeping the previous state");
+                    return EXIT_FAILURE;
+                }
+                field[e] = prev[e];
+            }
+        }
+
+        printf ("%3s%3s ", field[0], field[1]);
+        for (e = 2; e < nEnt; e++) {
+            printf ("%4s", field[e]);
+        }
+        printf (" ");
+        for (e = nEnt; e < nEnt + NCOUNTERS; e++) {
+            printf ("%4s", field[e]);
+        }
+        printf ("\n");
+    }
+
+    if (fic != stdin) {
+        fclose (fic);
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,353 @@
+/**
+ *  \file logFilter.c (implementation file)
+ *
+ *  \brief Problem name: Air Lift.
+ *
+ *  Filter and analyzer of text logging files.
+ *
+ *  Native replacement of <tt>filter_log.awk</tt> for large logs (for instance, the concatenated logs of a batch of
+ *  runs). The file is read through <tt>logReader</tt>, so any number of passengers and both the full and the delta
+ *  formats are accepted.
+ *
+ *  Upon execution, the following parameters are accepted:
+ *    \li <tt>-s</tt>: print per flight summaries of every run and a histogram of the passengers per flight,
+ *        instead of the filtered log
+ *    \li name of the logging file (stdin, if absent or <tt>-</tt>).
+ *
+ *  The filtered log is the same as the one printed by <tt>filter_log.awk</tt>: in the lines of state, the entity
+ *  states equal to the ones in the previous line of state are replaced by ".". It is written to stdout.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+
+#include "logReader.h"
+
+/** \brief size of the output buffer */
+#define  OUTBUFSIZE    (1 << 16)
+
+/** \brief output buffer */
+static char outBuf[OUTBUFSIZE];
+
+/** \brief number of characters in the output buffer */
+static size_t outLen = 0;
+
+/**
+ *  \brief Writing the output buffer to stdout.
+ */
+
+static void outFlush (void)
+{
+    size_t done = 0;
+    ssize_t n;
+
+    while (done < outLen) {
+        if ((n = write (STDOUT_FILENO, outBuf + done, outLen - done)) == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            perror ("error on writing the output");
+            exit (EXIT_FAILURE);
+        }
+        done += (size_t) n;
+    }
+    outLen = 0;
+}
+
+/**
+ *  \brief Appending characters to the output buffer.
+ *
+ *  \param s characters
+ *  \param len number of characters
+ */
+
+static void outPut (const char *s, size_t len)
+{
+    if (outLen + len > OUTBUFSIZE) {
+        outFlush ();
+        if (len > OUTBUFSIZE) {
+            ssize_t n;
+
+            while (len > 0) {
+                if ((n = write (STDOUT_FILENO, s, len)) == -1) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+                    perror ("error on writing the output");
+                    exit (EXIT_FAILURE);
+                }
+                s += n;
+                len -= (size_t) n;
+            }
+            return;
+        }
+    }
+    memcpy (outBuf + outLen, s, len);
+    outLen += len;
+}
+
+/**
+ *  \brief Appending a right aligned field, followed by a blank, to the output buffer.
+ *
+ *  Same as <tt>printf ("%*d ", width, val)</tt> or, if <tt>val</tt> is negative, <tt>printf ("%*s ", width, ".")</tt>.
+ *
+ *  \param width field width
+ *  \param val value to be printed (non-negative), or -1 for "."
+ */
+
+static void outField (int width, int val)
+{
+    char digits[16];
+    int n = 0;
+
+    if (val < 0) {
+        digits[n++] = '.';
+    }
+    else {
+        do {
+            digits[n++] = (char) ('0' + val % 10);
+            val /= 10;
+        } while (val > 0);
+    }
+    if (outLen + (size_t) (width + n + 1) > OUTBUFSIZE) {
+        outFlush ();
+    }
+    for (; width > n; width--) {
+        outBuf[outLen++] = ' ';
+    }
+    while (n > 0) {
+        outBuf[outLen++] = digits[--n];
+    }
+    outBuf[outLen++] = ' ';
+}
+
+/**
+ *  \brief Printing a line of state in the filtered format.
+ *
+ *  The field widths are the ones of <tt>filter_log.awk</tt>: 3 for the pilot, 2 for the hostess, 4 for the first
+ *  passenger, 3 for the remaining ones and 4, 3, 3 for the counters.
+ *
+ *  \param line pointer to the line of state
+ *  \param nEnt number of entities
+ *  \param prev entity states in the previous line of state (updated); all 0 before the first one, as in awk
+ */
+
+static void filterState (const LOG_LINE *line, int nEnt, int *prev)
+{
+    int e, c;
+
+    for (e = 0; e < nEnt; e++) {
+        int width = (e == 0) ? 3 : (e == 1) ? 2 : (e == 2) ? 4 : 3;
+
+        outField (width, (line->stat[e] == prev[e]) ? -1 : line->stat[e]);
+        prev[e] = line->stat[e];
+    }
+    for (c = 0; c < NCOUNTERS; c++) {
+        outField ((c == 0) ? 4 : 3, line->cnt[c]);
+    }
+    outPut ("\n", 1);
+}
+
+/**
+ *  \brief Definition of <em>flight summary</em> data type.
+ */
+typedef struct
+{ /** \brief flight number */
+    int flight;
+    /** \brief number of passengers checked */
+    int nChecked;
+    /** \brief number of passengers at departure (-1, if the flight did not depart) */
+    int nDeparted;
+    /** \brief largest number of passengers in queue during boarding */
+    int maxInQueue;
+    /** \brief number of lines of state from the start of boarding to the return */
+    unsigned long nStates;
+    /** \brief the flight arrived at the destination */
+    bool arrived;
+    /** \brief the flight returned */
+    bool returned;
+
+} FLIGHT_SUM;
+
+/**
+ *  \brief Definition of <em>analysis</em> data type.
+ */
+typedef struct
+{ /** \brief number of runs */
+    int nRuns;
+    /** \brief summary of the current flight */
+    FLIGHT_SUM cur;
+    /** \brief a flight is in progress */
+    bool inFlight;
+    /** \brief number of flights in all runs */
+    unsigned long nFlights;
+    /** \brief number of lines of state in all runs */
+    unsigned long nStates;
+    /** \brief number of flights per number of passengers at departure */
+    unsigned long *hist;
+    /** \brief size of the histogram */
+    int histSize;
+
+} ANALYSIS;
+
+/**
+ *  \brief Printing the summary of a flight and adding it to the histogram.
+ *
+ *  \param an pointer to the analysis
+ */
+
+static void endFlight (ANALYSIS *an)
+{
+    FLIGHT_SUM *f = &an->cur;
+
+    if (!an->inFlight) {
+        return;
+    }
+    printf ("%5d %6d %8d %8d %7d %7s %8s %8lu\n", an->nRuns, f->flight, f->nChecked, f->nDeparted, f->maxInQueue,
+            f->arrived ? "yes" : "no", f->returned ? "yes" : "no", f->nStates);
+    if (f->nDeparted >= 0) {
+        if (f->nDeparted >= an->histSize) {
+            int size = f->nDeparted + 1;
+
+            if ((an->hist = realloc (an->hist, (size_t) size * sizeof (unsigned long))) == NULL) {
+                perror ("error on allocating the histogram");
+                exit (EXIT_FAILURE);
+            }
+            memset (an->hist + an->histSize, 0, (size_t) (size - an->histSize) * sizeof (unsigned long));
+            an->histSize = size;
+        }
+        an->hist[f->nDeparted] += 1;
+    }
+    an->nFlights += 1;
+    an->inFlight = false;
+}
+
+/**
+ *  \brief Adding a line to the analysis.
+ *
+ *  \param an pointer to the analysis
+ *  \param line pointer to the line
+ */
+
+static void analyzeLine (ANALYSIS *an, const LOG_LINE *line)
+{
+    switch (line->kind) {
+    case LINE_TITLE:
+        endFlight (an);
+        an->nRuns += 1;
+        break;
+    case LINE_BOARDING:
+        endFlight (an);
+        memset (&an->cur, 0, sizeof (FLIGHT_SUM));
+        an->cur.flight = line->flight;
+        an->cur.nDeparted = -1;
+        an->inFlight = true;
+        break;
+    case LINE_CHECKED:
+        an->cur.nChecked += 1;
+        break;
+    case LINE_DEPARTED:
+        an->cur.nDeparted = line->value;
+        break;
+    case LINE_ARRIVED:
+        an->cur.arrived = true;
+        break;
+    case LINE_RETURNING:
+        an->cur.returned = true;
+        break;
+    case LINE_RESULT:
+        endFlight (an);
+        break;
+    case LINE_STATE:
+        an->nStates += 1;
+        if (an->inFlight) {
+            an->cur.nStates += 1;
+            if (an->cur.nDeparted < 0 && line->cnt[0] > an->cur.maxInQueue) {
+                an->cur.maxInQueue = line->cnt[0];
+            }
+        }
+        break;
+    }
+}
+
+/**
+ *  \brief Main program.
+ *
+ *  Its role is reading the log and printing either the filtered log or the flight summaries.
+ */
+
+int main (int argc, char *argv[])
+{
+    LOG_READER lr;                                                                                       /* log reader */
+    LOG_LINE line;                                                                                        /* line read */
+    bool summary = false;                                                              /* print the flight summaries */
+    int *prev = NULL;                                                  /* entity states in the previous line of state */
+    int nPrev = 0;                                                             /* number of entity states in prev */
+    ANALYSIS an;
+    int opt, n;
+
+    while ((opt = getopt (argc, argv, "s")) != -1) {
+        switch (opt) {
+        case 's':
+            summary = true;
+            break;
+        default:
+            fprintf (stderr, "Usage: %s [-s] [log file]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (optind + 1 < argc) {
+        fprintf (stderr, "Usage: %s [-s] [log file]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    if (logReaderOpen (&lr, (optind < argc) ? argv[optind] : NULL) == -1) {
+        perror ("error on opening the log file");
+        return EXIT_FAILURE;
+    }
+
+    if (summary) {
+        memset (&an, 0, sizeof (an));
+        printf ("%5s %6s %8s %8s %7s %7s %8s %8s\n", "Run", "Flight", "Checked", "Departed", "MaxQ", "Arrived",
+                "Returned", "States");
+        while (logReaderNext (&lr, &line)) {
+            analyzeLine (&an, &line);
+        }
+        endFlight (&an);
+        printf ("\n%d runs, %lu flights, %lu lines of state\n", an.nRuns, an.nFlights, an.nStates);
+        printf ("Passengers per flight:\n");
+        for (n = 0; n < an.histSize; n++) {
+            if (an.hist[n] > 0) {
+                printf ("%5d %10lu\n", n, an.hist[n]);
+            }
+        }
+        free (an.hist);
+    }
+    else {
+        while (logReaderNext (&lr, &line)) {
+            if (line.kind == LINE_STATE) {
+                if (lr.nEnt != nPrev) {
+                    free (prev);
+                    if ((prev = calloc ((size_t) lr.nEnt, sizeof (int))) == NULL) {
+                        perror ("error on allocating the previous state");
+                        return EXIT_FAILURE;
+                    }
+                    nPrev = lr.nEnt;
+                }
+                filterState (&line, nPrev, prev);
+            }
+            else {
+                outPut (line.text, line.len);
+                outPut ("\n", 1);
+            }
+        }
+        outFlush ();
+        free (prev);
+    }
+
+    logReaderClose (&lr);
+    return EXIT_SUCCESS;
+}
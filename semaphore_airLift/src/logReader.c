@@ -0,0 +1,382 @@
+/**
+ *  \file logReader.c (implementation file)
+ *
+ *  \brief Problem name: Air Lift.
+ *
+ *  \brief Reading text logging files.
+ *
+ *  The file is mapped onto the process address space and split into lines by a hand-written tokenizer.
+ *  The number of passengers and the layout of the lines of state are taken from the header line
+ *  (<tt>PT HT P00 ...</tt>) written by the logging operations, so logs of any size are accepted.
+ *  Lines of state in the delta format are expanded.
+ *
+ *  Defined operations:
+ *     \li opening of a logging file
+ *     \li reading the next line
+ *     \li closing of a logging file.
+ */
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+
+#include "logReader.h"
+
+/** \brief size of the blocks in which stdin is read */
+#define  READBLOCK      (1 << 20)
+
+/**
+ *  \brief Test if a line starts with a given prefix.
+ *
+ *  \param s start of the line
+ *  \param end end of the line
+ *  \param prefix prefix
+ *
+ *  \return pointer to the first character after the prefix, or NULL if the line does not start with it
+ */
+
+static const char *skipPrefix (const char *s, const char *end, const char *prefix)
+{
+    size_t n = strlen (prefix);
+
+    if (((size_t) (end - s) < n) || (memcmp (s, prefix, n) != 0)) {
+        return NULL;
+    }
+    return s + n;
+}
+
+/**
+ *  \brief Reading a non-negative decimal number.
+ *
+ *  \param s start of the number
+ *  \param end end of the line
+ *  \param val pointer to the location where the number is stored
+ *
+ *  \return pointer to the first character after the number, or NULL if there is no number at <tt>s</tt>
+ */
+
+static const char *readNumber (const char *s, const char *end, int *val)
+{
+    int v = 0;
+
+    if ((s == NULL) || (s == end) || (*s < '0') || (*s > '9')) {
+        return NULL;
+    }
+    while ((s < end) && (*s >= '0') && (*s <= '9')) {
+        v = v * 10 + (*s++ - '0');
+    }
+    *val = v;
+    return s;
+}
+
+/**
+ *  \brief Finding the layout of the lines of state from the header line.
+ *
+ *  \param lr pointer to the reader
+ *  \param s start of the line
+ *  \param end end of the line
+ *
+ *  \return \c true, if this is a header line
+ */
+
+static bool readHeader (LOG_READER *lr, const char *s, const char *end)
+{
+    int nEnt = 0;
+
+    while ((s < end) && (*s == ' ')) {
+        s++;
+    }
+    if ((skipPrefix (s, end, "PT") == NULL) || (memmem (s, (size_t) (end - s), "HT", 2) == NULL)) {
+        return false;
+    }
+    for (; s + 2 < end; s++) {
+        if ((s[0] == ' ') && (s[1] == 'P') && (s[2] >= '0') && (s[2] <= '9')) {
+            nEnt += 1;                                                                                   /* passenger */
+        }
+    }
+    nEnt += 2;                                                                                /* pilot and hostess */
+    if (nEnt != lr->nEnt) {
+        free (lr->stat);
+        free (lr->shown);
+        lr->stat = calloc ((size_t) nEnt, sizeof (int));
+        lr->shown = calloc ((size_t) nEnt, sizeof (bool));
+        if ((lr->stat == NULL) || (lr->shown == NULL)) {
+            perror ("error on allocating the state of the entities");
+            exit (EXIT_FAILURE);
+        }
+        lr->nEnt = nEnt;
+        lr->known = false;
+    }
+    return true;
+}
+
+/**
+ *  \brief Reading a line of state.
+ *
+ *  The fields are the entity states (a number or ".") followed by the counters.
+ *  The state of the entities kept by the reader is only changed if the whole line is valid.
+ *
+ *  \param lr pointer to the reader
+ *  \param s start of the line
+ *  \param end end of the line
+ *  \param line pointer to the line
+ *
+ *  \return \c true, if this is a line of state
+ */
+
+static bool readState (LOG_READER *lr, const char *s, const char *end, LOG_LINE *line)
+{
+    int f = 0, val;
+    int nFields = lr->nEnt + NCOUNTERS;
+    const char *t = s;
+
+    if (lr->nEnt < 0) {
+        return false;
+    }
+    for (;;) {                                                                /* validate the line before using it */
+        while ((t < end) && (*t == ' ')) {
+            t++;
+        }
+        if (t == end) {
+            break;
+        }
+        if (f == nFields) {
+            return false;
+        }
+        if ((*t == '.') && (f < lr->nEnt) && ((t + 1 == end) || (t[1] == ' '))) {
+            if (!lr->known) {
+                return false;                                                          /* no previous value */
+            }
+            t++;
+        }
+        else if ((t = readNumber (t, end, &val)) == NULL) {
+            return false;
+        }
+        if ((t < end) && (*t != ' ')) {
+            return false;
+        }
+        f += 1;
+    }
+    if (f != nFields) {
+        return false;
+    }
+
+    for (f = 0, t = s; f < nFields; f++) {
+        while (*t == ' ') {
+            t++;
+        }
+        if (*t == '.') {
+            lr->shown[f] = false;
+            t++;
+        }
+        else {
+            t = readNumber (t, end, &val);
+            if (f < lr->nEnt) {
+                lr->stat[f] = val;
+                lr->shown[f] = true;
+            }
+            else line->cnt[f - lr->nEnt] = val;
+        }
+    }
+    lr->known = true;
+    line->stat = lr->stat;
+    line->shown = lr->shown;
+    return true;
+}
+
+/**
+ *  \brief Reading a flight event or summary line.
+ *
+ *  \param s start of the line
+ *  \param end end of the line
+ *  \param line pointer to the line
+ *
+ *  \return \c true, if this is a flight event or summary line
+ */
+
+static bool readEvent (const char *s, const char *end, LOG_LINE *line)
+{
+    const char *t;
+
+    if ((t = skipPrefix (s, end, "Flight ")) != NULL) {
+        if ((t = readNumber (t, end, &line->flight)) == NULL) {
+            return false;
+        }
+        if (skipPrefix (t, end, " : Boarding Started") != NULL) {
+            line->kind = LINE_BOARDING;
+        }
+        else if (readNumber (skipPrefix (t, end, " : Passenger "), end, &line->value) != NULL) {
+            line->kind = LINE_CHECKED;
+        }
+        else if (readNumber (skipPrefix (t, end, " : Departed with "), end, &line->value) != NULL) {
+            line->kind = LINE_DEPARTED;
+        }
+        else if (skipPrefix (t, end, " : Arrived") != NULL) {
+            line->kind = LINE_ARRIVED;
+        }
+        else if (skipPrefix (t, end, " : Returning") != NULL) {
+            line->kind = LINE_RETURNING;
+        }
+        else if ((t = skipPrefix (t, end, " took ")) != NULL) {
+            while ((t < end) && (*t == ' ')) {
+                t++;
+            }
+            if (readNumber (t, end, &line->value) == NULL) {
+                return false;
+            }
+            line->kind = LINE_TOOK;
+        }
+        else return false;
+        return true;
+    }
+    if (skipPrefix (s, end, "AirLift result") != NULL) {
+        line->kind = LINE_RESULT;
+        return true;
+    }
+    if (readNumber (skipPrefix (s, end, "AirLift used "), end, &line->value) != NULL) {
+        line->kind = LINE_USED;
+        return true;
+    }
+    return false;
+}
+
+/**
+ *  \brief Opening of a logging file.
+ *
+ *  The file is mapped onto the process address space.
+ *  If <tt>nFic</tt> is a null pointer or the string <tt>-</tt>, stdin is read into memory instead.
+ *
+ *  \param lr pointer to the reader
+ *  \param nFic name of the logging file
+ *
+ *  \return \c 0, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+int logReaderOpen (LOG_READER *lr, const char *nFic)
+{
+    int fd;                                                                                         /* file descriptor */
+    struct stat st;                                                                                    /* file status */
+
+    memset (lr, 0, sizeof (LOG_READER));
+    lr->nEnt = -1;
+    lr->lineNo = 1;
+
+    if ((nFic == NULL) || (strcmp (nFic, "-") == 0)) {
+        char *buf = NULL, *nbuf;
+        size_t cap = 0;
+        ssize_t n;
+
+        do {
+            if (lr->size + READBLOCK > cap) {
+                cap = 2 * cap + READBLOCK;
+                if ((nbuf = realloc (buf, cap)) == NULL) {
+                    free (buf);
+                    return -1;
+                }
+                buf = nbuf;
+            }
+            if ((n = read (STDIN_FILENO, buf + lr->size, cap - lr->size)) == -1) {
+                free (buf);
+                return -1;
+            }
+            lr->size += (size_t) n;
+        } while (n > 0);
+        lr->data = buf;
+        lr->allocated = true;
+        return 0;
+    }
+
+    if ((fd = open (nFic, O_RDONLY)) == -1) {
+        return -1;
+    }
+    if (fstat (fd, &st) == -1) {
+        close (fd);
+        return -1;
+    }
+    lr->size = (size_t) st.st_size;
+    if (lr->size > 0) {
+        void *map = mmap (NULL, lr->size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+        if (map == MAP_FAILED) {
+            close (fd);
+            return -1;
+        }
+        madvise (map, lr->size, MADV_SEQUENTIAL);
+        lr->data = map;
+    }
+    close (fd);
+    return 0;
+}
+
+/**
+ *  \brief Reading the next line.
+ *
+ *  \param lr pointer to the reader
+ *  \param line pointer to the location where the line is stored
+ *
+ *  \return \c true, upon success
+ *  \return \c false, at the end of the file
+ */
+
+bool logReaderNext (LOG_READER *lr, LOG_LINE *line)
+{
+    const char *s, *end;
+
+    if (lr->pos >= lr->size) {
+        return false;
+    }
+    s = lr->data + lr->pos;
+    if ((end = memchr (s, '\n', lr->size - lr->pos)) == NULL) {
+        end = lr->data + lr->size;
+    }
+    lr->pos = (size_t) (end - lr->data) + 1;
+
+    memset (line, 0, sizeof (LOG_LINE));
+    line->text = s;
+    line->len = (size_t) (end - s);
+    line->lineNo = lr->lineNo++;
+    line->kind = LINE_OTHER;
+
+    if ((*s >= '0' && *s <= '9') || (*s == ' ') || (*s == '.')) {
+        if (readState (lr, s, end, line)) {
+            line->kind = LINE_STATE;
+        }
+        else if (readHeader (lr, s, end)) {
+            line->kind = LINE_HEADER;
+        }
+    }
+    else readEvent (s, end, line);
+    if ((line->kind == LINE_OTHER) && (memmem (s, line->len, "Air Lift - Description", 22) != NULL)) {
+        line->kind = LINE_TITLE;                                                                 /* a new run starts */
+        lr->known = false;
+    }
+    return true;
+}
+
+/**
+ *  \brief Closing of a logging file.
+ *
+ *  \param lr pointer to the reader
+ */
+
+void logReaderClose (LOG_READER *lr)
+{
+    if (lr->allocated) {
+        free ((void *) lr->data);
+    }
+    else if (lr->size > 0) {
+        munmap ((void *) lr->data, lr->size);
+    }
+    free (lr->stat);
+    free (lr->shown);
+    memset (lr, 0, sizeof (LOG_READER));
+}
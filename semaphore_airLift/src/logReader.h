@@ -0,0 +1,141 @@
+/**
+ *  \file logReader.h (interface file)
+ *
+ *  \brief Problem name: Air Lift.
+ *
+ *  \brief Reading text logging files.
+ *
+ *  The file is mapped onto the process address space and split into lines by a hand-written tokenizer.
+ *  The number of passengers and the layout of the lines of state are taken from the header line
+ *  (<tt>PT HT P00 ...</tt>) written by the logging operations, so logs of any size are accepted.
+ *  Lines of state in the delta format are expanded.
+ *
+ *  Defined operations:
+ *     \li opening of a logging file
+ *     \li reading the next line
+ *     \li closing of a logging file.
+ */
+
+#ifndef LOGREADER_H_
+#define LOGREADER_H_
+
+#include <stddef.h>
+#include <stdbool.h>
+
+/* Line kinds */
+
+/** \brief line not recognized (copied as is) */
+#define  LINE_OTHER                   0
+/** \brief title line: a new run starts */
+#define  LINE_TITLE                   1
+/** \brief header line */
+#define  LINE_HEADER                  2
+/** \brief line of state */
+#define  LINE_STATE                   3
+/** \brief start of boarding: <tt>Flight f : Boarding Started</tt> */
+#define  LINE_BOARDING                4
+/** \brief passenger checked: <tt>Flight f : Passenger p checked</tt> */
+#define  LINE_CHECKED                 5
+/** \brief flight departed: <tt>Flight f : Departed with n passengers</tt> */
+#define  LINE_DEPARTED                6
+/** \brief flight arrived: <tt>Flight f : Arrived</tt> */
+#define  LINE_ARRIVED                 7
+/** \brief flight returning: <tt>Flight f : Returning</tt> */
+#define  LINE_RETURNING               8
+/** \brief start of the summary: <tt>AirLift result</tt> */
+#define  LINE_RESULT                  9
+/** \brief number of flights: <tt>AirLift used n Flights</tt> */
+#define  LINE_USED                   10
+/** \brief passengers of one flight: <tt>Flight f took n passengers</tt> */
+#define  LINE_TOOK                   11
+
+/** \brief number of counters at the end of a line of state (waiting, flying, boarded) */
+#define  NCOUNTERS                    3
+
+/**
+ *  \brief Definition of <em>line of a logging file</em> data type.
+ */
+typedef struct
+{ /** \brief line kind */
+    int kind;
+    /** \brief start of the line in the file */
+    const char *text;
+    /** \brief size of the line, newline excluded */
+    size_t len;
+    /** \brief line number (from 1) */
+    unsigned long lineNo;
+    /** \brief flight number (flight events and summary) */
+    int flight;
+    /** \brief passenger id (<tt>LINE_CHECKED</tt>) or number of passengers / flights (<tt>LINE_DEPARTED</tt>,
+        <tt>LINE_USED</tt>, <tt>LINE_TOOK</tt>) */
+    int value;
+    /** \brief state of the entities (<tt>LINE_STATE</tt>): pilot, hostess and passengers; owned by the reader */
+    const int *stat;
+    /** \brief the entity state was written in the line (not "." in the delta format); owned by the reader */
+    const bool *shown;
+    /** \brief counters (<tt>LINE_STATE</tt>): passengers waiting, flying and boarded */
+    int cnt[NCOUNTERS];
+
+} LOG_LINE;
+
+/**
+ *  \brief Definition of <em>logging file reader</em> data type.
+ */
+typedef struct
+{ /** \brief mapping of the file */
+    const char *data;
+    /** \brief size of the file */
+    size_t size;
+    /** \brief location of the next line */
+    size_t pos;
+    /** \brief number of the next line */
+    unsigned long lineNo;
+    /** \brief the data was read into allocated memory instead of being mapped */
+    bool allocated;
+    /** \brief number of entities (pilot, hostess and passengers); -1 until the header is found */
+    int nEnt;
+    /** \brief state of the entities in the last line of state */
+    int *stat;
+    /** \brief the entity state was written in the last line of state */
+    bool *shown;
+    /** \brief state of the entities has been set since the start of the run */
+    bool known;
+
+} LOG_READER;
+
+/**
+ *  \brief Opening of a logging file.
+ *
+ *  The file is mapped onto the process address space.
+ *  If <tt>nFic</tt> is a null pointer or the string <tt>-</tt>, stdin is read into memory instead.
+ *
+ *  \param lr pointer to the reader
+ *  \param nFic name of the logging file
+ *
+ *  \return \c 0, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+extern int logReaderOpen (LOG_READER *lr, const char *nFic);
+
+/**
+ *  \brief Reading the next line.
+ *
+ *  \param lr pointer to the reader
+ *  \param line pointer to the location where the line is stored
+ *
+ *  \return \c true, upon success
+ *  \return \c false, at the end of the file
+ */
+
+extern bool logReaderNext (LOG_READER *lr, LOG_LINE *line);
+
+/**
+ *  \brief Closing of a logging file.
+ *
+ *  \param lr pointer to the reader
+ */
+
+extern void logReaderClose (LOG_READER *lr);
+
+#endif /* LOGREADER_H_ */
@@ -6,13 +6,28 @@
  *  \brief Logging the internal state of the problem into a file.
  *
  *  Defined operations:
+ *     \li opening, flushing and closing of the log session
  *     \li file initialization
  *     \li writing the start of boarding at the end of the file
  *     \li writing the start of flight at end of the file.
  *     \li writing the present full state as a single line at the end of the file.
  *     \li Writing the flight arrival at the end of the file.
  *     \li Writing the flight returning at the end of the file.
- *     \li writing summary of air lift at the end of the file.
+ *     \li writing summary of air lift at the end of the file
+ *     \li printing a logging event record in text format.
+ *
+ *  Every logging operation is described by a fixed-size event record.
+ *  In the default build the record is printed right away in text format.
+ *  When compiled with <tt>LOG_BINARY</tt>, the record is appended instead to an event ring in shared memory, which
+ *  is written in binary format to the logging file when it gets full and at the end of the session; the text log
+ *  is then rebuilt offline by the <em>logDecoder</em> tool.
+ *  When compiled with <tt>LOG_DEFERRED</tt>, the record only gets a sequence number and is kept by the calling process
+ *  inside the critical region; it is printed afterwards, outside of it, into a spool file shared by all the
+ *  processes, which the process that created the logging file merges into it in sequence order at the end.
+ *  In the delta format, the entities whose state did not change since the previous line of state are marked in the
+ *  record, inside the critical region, and printed as ".".
+ *  When compiled with <tt>LOG_ASYNC</tt>, the record is pushed into a lock-free queue in shared memory; a dedicated
+ *  logger process takes the records out of it and is the only one to write the logging file.
  *
  *  \author Nuno Lau - January 2022
  */
@@ -21,13 +36,110 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdbool.h>
+#include <time.h>
+#include <errno.h>
+#include <sched.h>
 
 #include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
 #include <unistd.h>
 
 
 #include "probConst.h"
 #include "probDataStruct.h"
+#include "logging.h"
+
+/** \brief size of the user-space buffer attached to the session log file */
+#define  LOGBUFSIZE     65536
+
+/** \brief log file kept open during the log session (NULL when no session is open) */
+static FILE *sessionFic = NULL;
+
+/** \brief name of the log file bound to the log session */
+static char sessionName[256];
+
+/** \brief user-space buffer of the log session */
+static char sessionBuf[LOGBUFSIZE];
+
+/** \brief logging data shared by all the intervening entities (NULL when no session is open) */
+static LOG_SHARED *sessionShared = NULL;
+
+/** \brief this process created the logging file */
+static bool logOwner = false;
+
+/** \brief logging level of this process */
+static unsigned int logLevel = LOG_LEVEL_FULL;
+
+/** \brief clock the event records are time stamped with (NULL, for the monotonic clock) */
+static unsigned long long (*logClock) (void) = NULL;
+
+/** \brief width of the pilot and hostess columns of the line of state */
+#define  ENTWIDTH       3
+
+/** \brief width of the passenger and counter columns of the line of state */
+#define  COLWIDTH       4
+
+/** \brief location of the column of passenger <tt>p</tt> in the line of state */
+#define  PASSCOL(p)     (2 * ENTWIDTH + 1 + (p) * COLWIDTH)
+
+/** \brief location of counter <tt>c</tt> (waiting, flying, boarded) in the line of state */
+#define  CNTCOL(c)      (PASSCOL (N) + 1 + (c) * COLWIDTH)
+
+/** \brief size of the line of state (newline included) */
+#define  STATELINESIZE  (CNTCOL (3) + 1)
+
+/** \brief number of passenger states compared at once when looking for changes */
+#define  STATCHUNK      8
+
+/** \brief line of state last printed by this process, patched in place for the next one */
+static char stateLine[STATELINESIZE];
+
+/** \brief packed states shown in <tt>stateLine</tt> */
+static unsigned char lineStat[N+2];
+
+/** \brief counters shown in <tt>stateLine</tt> */
+static unsigned int lineCnt[3];
+
+/** \brief <tt>stateLine</tt> holds a complete line */
+static bool lineReady = false;
+
+#ifdef LOG_DEFERRED
+
+/** \brief number of event records a process keeps before printing them */
+#define  LOGPENDSIZE    256
+
+/** \brief maximum size of the text of an event record (two lines with one column per entity) */
+#define  LOGRECTEXT     (8 * N + 256)
+
+/**
+ *  \brief Definition of <em>spooled event record header</em> data type.
+ */
+typedef struct
+{ /** \brief sequence number of the event */
+    unsigned int seq;
+    /** \brief size of the text of the event (in bytes) */
+    unsigned int len;
+
+} SPOOL_HDR;
+
+/** \brief event records kept by this process, not yet printed */
+static LOG_REC pending[LOGPENDSIZE];
+
+/** \brief number of event records kept by this process */
+static unsigned int nPending = 0;
+
+/** \brief name of the spool file */
+static char spoolName[sizeof (sessionName) + 8];
+
+/** \brief spool file descriptor (-1 when not open) */
+static int spoolFd = -1;
+
+/** \brief printed event records, gathered to be appended to the spool file with a single write */
+static char *spoolChunk = NULL;
+
+#endif
 
 static FILE *openLog(char nFic[], char mode[])
 {
@@ -38,6 +150,9 @@ static FILE *openLog(char nFic[], char mode[])
         return stdout;
     }
     else fName = nFic;
+    if ((sessionFic != NULL) && (strcmp (mode, "a") == 0) && (strcmp (fName, sessionName) == 0)) {
+        return sessionFic;                                                   /* reuse the file kept open by the session */
+    }
     //fprintf(stderr,"%d opening log %s %s\n",getpid(),nFic,mode);
     if ((fic = fopen (fName, mode)) == NULL) {
         perror ("error on opening log file");
@@ -48,8 +163,13 @@ static FILE *openLog(char nFic[], char mode[])
 
 static void closeLog(FILE *fic)
 {
-    if(fic==stderr || fic == stdout) {
-         fflush(fic);
+    if(fic==stderr || fic == stdout || fic == sessionFic) {
+         /* lines are written while the caller holds the critical region, so they must reach the file before
+            it is released to keep the global order of the log; this is a single write system call */
+         if (fflush (fic) == EOF) {
+             perror ("error on flushing the log file");
+             exit (EXIT_FAILURE);
+         }
          return;
     }
 
@@ -77,6 +197,676 @@ static void printHeader(FILE *fic)
     fprintf(fic,"\n");
 }
 
+/**
+ *  \brief Writing a value right-justified in a column of the line of state.
+ *
+ *  \param col pointer to the column
+ *  \param width column width
+ *  \param val value
+ *  \param state the value is a packed entity state (<tt>LOG_UNCHANGED</tt> is written as ".")
+ *
+ *  \return \c true, upon success
+ *  \return \c false, if the value does not fit in the column
+ */
+
+static bool putColumn (char *col, int width, unsigned int val, bool state)
+{
+    int w = width;
+
+    if (state && (val == LOG_UNCHANGED)) {                                         /* unchanged entity in the delta format */
+        memset (col, ' ', (size_t) (width - 1));
+        col[width-1] = '.';
+        return true;
+    }
+    do {
+        col[--w] = (char) ('0' + val % 10);
+        val /= 10;
+    } while ((val > 0) && (w > 0));
+    if (val > 0) {
+        return false;
+    }
+    while (w > 0) {
+        col[--w] = ' ';
+    }
+    return true;
+}
+
+/**
+ *  \brief Printing a packed entity state in a column of given width.
+ *
+ *  \param fic file descriptor
+ *  \param width column width
+ *  \param stat packed state (<tt>LOG_UNCHANGED</tt> is printed as ".")
+ */
+
+static void printStat (FILE *fic, int width, unsigned char stat)
+{
+    if (stat == LOG_UNCHANGED) {
+        fprintf (fic, "%*s", width, ".");
+    }
+    else fprintf (fic, "%*d", width, stat);
+}
+
+/**
+ *  \brief Rendering an event record of state in <tt>stateLine</tt>.
+ *
+ *  The line keeps the layout of the header (fixed-width columns).
+ *  Only the columns whose value differs from the previous line printed by this process are rewritten;
+ *  the passenger states are compared a chunk at a time, so unchanged stretches are skipped quickly.
+ *
+ *  \param rec pointer to the event record
+ *
+ *  \return \c true, upon success
+ *  \return \c false, if some value is wider than its column (the line must then be printed field by field)
+ */
+
+static bool renderState (LOG_REC *rec)
+{
+    unsigned int cnt[3] = { rec->nPassInQueue, rec->nPassInFlight, rec->totalPassBoarded };       /* counters */
+    bool fits = true;
+    int p, q, i, c;
+
+    if (!lineReady) {
+        memset (stateLine, ' ', STATELINESIZE);
+        stateLine[STATELINESIZE-1] = '\n';
+        fits = putColumn (stateLine, ENTWIDTH, rec->stat[0], true);
+        fits = putColumn (stateLine + ENTWIDTH, ENTWIDTH, rec->stat[1], true) && fits;
+        for (p = 0; p < N; p++) {
+            fits = putColumn (stateLine + PASSCOL (p), COLWIDTH, rec->stat[p+2], true) && fits;
+        }
+        for (c = 0; c < 3; c++) {
+            fits = putColumn (stateLine + CNTCOL (c), COLWIDTH, cnt[c], false) && fits;
+        }
+    }
+    else {
+        if (rec->stat[0] != lineStat[0]) {
+            fits = putColumn (stateLine, ENTWIDTH, rec->stat[0], true);
+        }
+        if (rec->stat[1] != lineStat[1]) {
+            fits = putColumn (stateLine + ENTWIDTH, ENTWIDTH, rec->stat[1], true) && fits;
+        }
+        for (p = 0; p < N; p += STATCHUNK) {
+            q = (N - p < STATCHUNK) ? N - p : STATCHUNK;
+            if (memcmp (rec->stat + p + 2, lineStat + p + 2, (size_t) q) == 0) {
+                continue;
+            }
+            for (i = p; i < p + q; i++) {
+                if (rec->stat[i+2] != lineStat[i+2]) {
+                    fits = putColumn (stateLine + PASSCOL (i), COLWIDTH, rec->stat[i+2], true) && fits;
+                }
+            }
+        }
+        for (c = 0; c < 3; c++) {
+            if (cnt[c] != lineCnt[c]) {
+                fits = putColumn (stateLine + CNTCOL (c), COLWIDTH, cnt[c], false) && fits;
+            }
+        }
+    }
+    memcpy (lineStat, rec->stat, sizeof (lineStat));
+    memcpy (lineCnt, cnt, sizeof (lineCnt));
+    lineReady = fits;
+
+    return fits;
+}
+
+/**
+ *  \brief Filling an event record with the present full state.
+ *
+ *  \param type event type
+ *  \param p_fSt pointer to the location where the full internal state of the problem is stored
+ *  \param rec pointer to the event record
+ */
+
+static void packRecord (unsigned int type, FULL_STAT *p_fSt, LOG_REC *rec)
+{
+    struct timespec t;                                                                                 /* time stamp */
+    int p;
+
+    rec->type = type;
+    if (logClock != NULL) {
+        rec->time = logClock ();
+    }
+    else {
+        clock_gettime (CLOCK_MONOTONIC, &t);
+        rec->time = (unsigned long long) t.tv_sec * 1000000000ULL + (unsigned long long) t.tv_nsec;
+    }
+    rec->nFlight = p_fSt->nFlight;
+    rec->nPassInQueue = p_fSt->nPassInQueue;
+    rec->nPassInFlight = p_fSt->nPassInFlight;
+    rec->totalPassBoarded = p_fSt->totalPassBoarded;
+    rec->passengerChecked = p_fSt->passengerChecked;
+    rec->nPassengers = ((p_fSt->nFlight > 0) && (p_fSt->nFlight <= MAXNF)) ? p_fSt->nPassengersInFlight[p_fSt->nFlight-1]
+                                                                          : 0;
+    rec->stat[0] = (unsigned char) p_fSt->st.pilotStat;
+    rec->stat[1] = (unsigned char) p_fSt->st.hostessStat;
+    for (p = 0; p < N; p++) {
+        rec->stat[p+2] = (unsigned char) p_fSt->st.passengerStat[p];
+    }
+}
+
+#ifdef LOG_BINARY
+
+/**
+ *  \brief Writing the records held in the event ring at the end of the file.
+ *
+ *  The caller must have exclusive access to the ring.
+ */
+
+static void drainRing (void)
+{
+    FILE *fic = (sessionFic != NULL) ? sessionFic : stdout;                                         /* file descriptor */
+
+    if (sessionShared->nRec == 0) {
+        return;
+    }
+    if (fwrite (sessionShared->ring, sizeof (LOG_REC), sessionShared->nRec, fic) != sessionShared->nRec) {
+        perror ("error on writing the event ring to the log file");
+        exit (EXIT_FAILURE);
+    }
+    if (fflush (fic) == EOF) {
+        perror ("error on flushing the log file");
+        exit (EXIT_FAILURE);
+    }
+    sessionShared->nRec = 0;
+}
+
+#endif
+
+#ifdef LOG_DEFERRED
+
+/**
+ *  \brief Name of the spool file associated with a logging file.
+ *
+ *  \param nFic name of the logging file
+ *  \param name pointer to the location where the name of the spool file is stored
+ */
+
+static void spoolFileName (char nFic[], char name[])
+{
+    if ((nFic == NULL) || (strlen (nFic) == 0)) {
+        strcpy (name, "log.spool");
+    }
+    else sprintf (name, "%s.spool", nFic);
+}
+
+/**
+ *  \brief Printing the event records kept by the process at the end of the spool file.
+ *
+ *  The records are appended with a single write, so the ones of different processes never get mixed.
+ */
+
+static void flushPending (void)
+{
+    FILE *mem;                                                                                 /* in memory stream */
+    SPOOL_HDR hdr;                                                                           /* spooled record header */
+    size_t size = 0;                                                                          /* size of the chunk */
+    unsigned int r;
+
+    if ((nPending == 0) || (spoolFd == -1)) {
+        return;
+    }
+    for (r = 0; r < nPending; r++) {
+        if ((mem = fmemopen (spoolChunk + size + sizeof (hdr), LOGRECTEXT, "w")) == NULL) {
+            perror ("error on printing an event record");
+            exit (EXIT_FAILURE);
+        }
+        printRecord (mem, &pending[r]);
+        hdr.seq = pending[r].seq;
+        hdr.len = (unsigned int) ftell (mem);
+        fclose (mem);
+        memcpy (spoolChunk + size, &hdr, sizeof (hdr));
+        size += sizeof (hdr) + hdr.len;
+    }
+    if (write (spoolFd, spoolChunk, size) != (ssize_t) size) {
+        perror ("error on writing to the spool file");
+        exit (EXIT_FAILURE);
+    }
+    nPending = 0;
+}
+
+/**
+ *  \brief Merging the spool file into the logging file in sequence order.
+ *
+ *  All the other processes must have closed their log session.
+ *
+ *  \param fic file descriptor of the logging file
+ */
+
+static void mergeSpool (FILE *fic)
+{
+    struct stat st;                                                                             /* spool file status */
+    char *spool;                                                                       /* mapping of the spool file */
+    size_t *offset;                                                     /* location of the record of each event */
+    unsigned int nSeq = sessionShared->seq;                                                     /* number of events */
+    SPOOL_HDR hdr;                                                                           /* spooled record header */
+    size_t pos;
+    unsigned int s;
+
+    if (fstat (spoolFd, &st) == -1) {
+        perror ("error on accessing the spool file");
+        exit (EXIT_FAILURE);
+    }
+    if ((st.st_size == 0) || (nSeq == 0)) {
+        return;
+    }
+    if ((spool = mmap (NULL, (size_t) st.st_size, PROT_READ, MAP_PRIVATE, spoolFd, 0)) == MAP_FAILED) {
+        perror ("error on mapping the spool file");
+        exit (EXIT_FAILURE);
+    }
+    if ((offset = malloc (nSeq * sizeof (size_t))) == NULL) {
+        perror ("error on allocating the reorder table");
+        exit (EXIT_FAILURE);
+    }
+    for (s = 0; s < nSeq; s++) {
+        offset[s] = (size_t) -1;
+    }
+    for (pos = 0; pos + sizeof (hdr) <= (size_t) st.st_size; pos += sizeof (hdr) + hdr.len) {
+        memcpy (&hdr, spool + pos, sizeof (hdr));
+        if (hdr.seq < nSeq) {
+            offset[hdr.seq] = pos;
+        }
+    }
+    for (s = 0; s < nSeq; s++) {
+        if (offset[s] == (size_t) -1) {
+            fprintf (stderr, "event %u is missing from the spool file\n", s);
+            continue;
+        }
+        memcpy (&hdr, spool + offset[s], sizeof (hdr));
+        fwrite (spool + offset[s] + sizeof (hdr), 1, hdr.len, fic);
+    }
+    free (offset);
+    munmap (spool, (size_t) st.st_size);
+}
+
+#endif
+
+#ifdef LOG_ASYNC
+
+/** \brief number of times the logger polls an empty queue before sleeping */
+#define  LOGPOLLSPIN    1000
+
+/** \brief sleeping time of the logger when the queue is empty (in us) */
+#define  LOGPOLLSLEEP   100
+
+/**
+ *  \brief Pushing an event record into the queue.
+ *
+ *  Lock-free: a producer claims a position by advancing the tail and publishes the record by advancing the turn
+ *  of its slot. When the queue is full, the producer yields the processor until the logger frees a slot.
+ *
+ *  \param rec pointer to the event record
+ */
+
+static void pushRecord (LOG_REC *rec)
+{
+    LOG_SLOT *slot;                                                                              /* slot of the queue */
+    unsigned int pos, turn;
+
+    pos = __atomic_load_n (&sessionShared->qTail, __ATOMIC_RELAXED);
+    for (;;) {
+        slot = &sessionShared->queue[pos & (LOGQUEUESIZE - 1)];
+        turn = __atomic_load_n (&slot->turn, __ATOMIC_ACQUIRE);
+        if (turn == pos) {
+            if (__atomic_compare_exchange_n (&sessionShared->qTail, &pos, pos + 1, false,
+                                             __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                break;                                                                          /* position claimed */
+            }
+        }
+        else if ((int) (turn - pos) < 0) {
+            sched_yield ();                                                                     /* the queue is full */
+            pos = __atomic_load_n (&sessionShared->qTail, __ATOMIC_RELAXED);
+        }
+        else pos = __atomic_load_n (&sessionShared->qTail, __ATOMIC_RELAXED);
+    }
+    memcpy (&slot->rec, rec, sizeof (LOG_REC));
+    __atomic_store_n (&slot->turn, pos + 1, __ATOMIC_RELEASE);
+}
+
+/**
+ *  \brief Taking an event record from the queue (logger only).
+ *
+ *  The queue is reached through <tt>p_log</tt>, not the session, which the generator closes while the logger of the
+ *  threaded build may still be taking records.
+ *
+ *  \param p_log pointer to the logging data shared by all the intervening entities
+ *  \param rec pointer to the location where the event record is stored
+ *
+ *  \return \c true, if a record was taken
+ *  \return \c false, if the queue is empty
+ */
+
+static bool popRecord (LOG_SHARED *p_log, LOG_REC *rec)
+{
+    unsigned int pos = p_log->qHead;
+    LOG_SLOT *slot = &p_log->queue[pos & (LOGQUEUESIZE - 1)];                                   /* slot of the queue */
+
+    if (__atomic_load_n (&slot->turn, __ATOMIC_ACQUIRE) != pos + 1) {
+        return false;
+    }
+    memcpy (rec, &slot->rec, sizeof (LOG_REC));
+    __atomic_store_n (&slot->turn, pos + LOGQUEUESIZE, __ATOMIC_RELEASE);
+    p_log->qHead = pos + 1;
+    return true;
+}
+
+/**
+ *  \brief Service of the logger process.
+ *
+ *  The event records are taken from the queue, in the order they were pushed, printed into a large buffer and
+ *  written to the logging file when the buffer is full or the queue is empty.
+ *  The function returns when the queue is empty and no more records will be pushed.
+ *  If <tt>nFic</tt> is a null pointer or a null string, the lines are written to stdout.
+ *
+ *  \param nFic name of the logging file
+ *  \param p_log pointer to the logging data shared by all the intervening entities
+ */
+
+void serveLog (char nFic[], LOG_SHARED *p_log)
+{
+    FILE *fic;                                                                                      /* file descriptor */
+    LOG_REC rec;                                                                                     /* event record */
+    unsigned int idle = 0;                                                     /* number of polls of an empty queue */
+    bool pending = false;                                                        /* lines not yet written to file */
+
+    if ((nFic == NULL) || (strlen (nFic) == 0)) {
+        fic = stdout;
+    }
+    else if ((fic = fopen (nFic, "a")) == NULL) {
+        perror ("error on opening log file");
+        exit (EXIT_FAILURE);
+    }
+    if (setvbuf (fic, sessionBuf, _IOFBF, LOGBUFSIZE) != 0) {
+        perror ("error on setting the log file buffer");
+        exit (EXIT_FAILURE);
+    }
+
+    for (;;) {
+        if (popRecord (p_log, &rec)) {
+            printRecord (fic, &rec);
+            pending = true;
+            idle = 0;
+            continue;
+        }
+        if (pending) {                                            /* the queue is empty: write the batch of lines */
+            if (fflush (fic) == EOF) {
+                perror ("error on flushing the log file");
+                exit (EXIT_FAILURE);
+            }
+            pending = false;
+        }
+        if (__atomic_load_n (&p_log->qDone, __ATOMIC_ACQUIRE)) {
+            if (!popRecord (p_log, &rec)) {
+                break;
+            }
+            printRecord (fic, &rec);
+            pending = true;
+            continue;
+        }
+        if (++idle < LOGPOLLSPIN) {
+            sched_yield ();
+        }
+        else usleep (LOGPOLLSLEEP);
+    }
+
+    if (fic != stdout) {
+        if (fclose (fic) == EOF) {
+            perror ("error on closing of log file");
+            exit (EXIT_FAILURE);
+        }
+    }
+}
+
+#endif
+
+/**
+ *  \brief Marking the entities of an event record of state whose state did not change (delta format).
+ *
+ *  The packed state of those entities is replaced by <tt>LOG_UNCHANGED</tt>, which is printed as ".".
+ *  Records of other types are left untouched.
+ *
+ *  \param rec pointer to the event record
+ *  \param last packed state of the entities in the previous line of state, updated with the new one
+ */
+
+void markUnchanged (LOG_REC *rec, unsigned char last[])
+{
+    int e;
+
+    if (rec->type != LOG_STATE) {
+        return;
+    }
+    for (e = 0; e < N+2; e++) {
+        if (rec->stat[e] == last[e]) {
+            rec->stat[e] = LOG_UNCHANGED;
+        }
+        else last[e] = rec->stat[e];
+    }
+}
+
+/**
+ *  \brief Writing an event record.
+ *
+ *  In the default build the record is printed in text format at the end of the file.
+ *  In the binary build it is appended to the event ring, which is written to the file when it gets full; the
+ *  caller must be inside the critical region.
+ *  In the deferred build it is numbered and kept by the process; the caller must be inside the critical region.
+ *  In the asynchronous build it is pushed into the queue read by the logger process.
+ *  In the delta format (except in the binary build, whose records are always complete), the unchanged entities
+ *  are marked first; the caller must be inside the critical region.
+ *
+ *  \param nFic name of the logging file
+ *  \param rec pointer to the event record
+ */
+
+static void putRecord (char nFic[], LOG_REC *rec)
+{
+#ifndef LOG_BINARY
+    if ((sessionShared != NULL) && (sessionShared->format == LOG_DELTA)) {
+        markUnchanged (rec, sessionShared->lastStat);      /* the previous line is the last one of any process */
+    }
+#endif
+#ifdef LOG_BINARY
+    if (sessionShared == NULL) {
+        fprintf (stderr, "binary logging requires an open log session!\n");
+        exit (EXIT_FAILURE);
+    }
+    if (sessionShared->nRec == LOGRINGSIZE) {
+        drainRing ();
+    }
+    rec->seq = sessionShared->seq++;
+    memcpy (&sessionShared->ring[sessionShared->nRec], rec, sizeof (LOG_REC));
+    sessionShared->nRec += 1;
+#elif defined (LOG_DEFERRED)
+    if (sessionShared == NULL) {
+        fprintf (stderr, "deferred logging requires an open log session!\n");
+        exit (EXIT_FAILURE);
+    }
+    if (nPending == LOGPENDSIZE) {
+        flushPending ();                                      /* rare: the records get printed inside the region */
+    }
+    rec->seq = sessionShared->seq++;
+    memcpy (&pending[nPending], rec, sizeof (LOG_REC));
+    nPending += 1;
+#elif defined (LOG_ASYNC)
+    if (sessionShared == NULL) {
+        fprintf (stderr, "asynchronous logging requires an open log session!\n");
+        exit (EXIT_FAILURE);
+    }
+    rec->seq = __atomic_fetch_add (&sessionShared->seq, 1, __ATOMIC_RELAXED);
+    pushRecord (rec);
+#else
+    FILE *fic;                                                                                      /* file descriptor */
+
+    fic = openLog(nFic,"a");
+    printRecord (fic, rec);
+    closeLog(fic);
+#endif
+}
+
+/**
+ *  \brief Opening of the log session.
+ *
+ *  The logging file is opened once, in append mode, and kept open until the session is closed, so that the
+ *  following logging operations on the same file do not have to open and close it each time.
+ *  A large user-space buffer is attached to the file.
+ *  If <tt>nFic</tt> is a null pointer or a null string, the lines keep being written to stdout.
+ *  In the asynchronous build, the file is left to the logger process and the process that created the logging
+ *  file sets up the empty queue of event records.
+ *
+ *  \param nFic name of the logging file
+ *  \param p_log pointer to the logging data shared by all the intervening entities
+ */
+
+void openLogSession (char nFic[], LOG_SHARED *p_log)
+{
+    sessionShared = p_log;
+    if (logOwner) {                                             /* no line of state was printed before the first */
+        memset (p_log->lastStat, LOG_UNCHANGED, sizeof (p_log->lastStat));
+    }
+#ifdef LOG_ASYNC
+    if (logOwner) {                                                       /* the creator sets up the empty queue */
+        unsigned int q;
+
+        p_log->qTail = p_log->qHead = p_log->qDone = 0;
+        for (q = 0; q < LOGQUEUESIZE; q++) {
+            p_log->queue[q].turn = q;
+        }
+    }
+    return;                                                         /* only the logger process writes the file */
+#endif
+#ifdef LOG_DEFERRED
+    if (spoolFd == -1) {
+        spoolFileName (nFic, spoolName);
+        if ((spoolFd = open (spoolName, O_RDWR | O_APPEND | O_CREAT | O_CLOEXEC, 0600)) == -1) {
+            perror ("error on opening the spool file");
+            exit (EXIT_FAILURE);
+        }
+        if ((spoolChunk = malloc (LOGPENDSIZE * (sizeof (SPOOL_HDR) + LOGRECTEXT))) == NULL) {
+            perror ("error on allocating the spool buffer");
+            exit (EXIT_FAILURE);
+        }
+    }
+#endif
+    if ((nFic == NULL) || (strlen (nFic) == 0) || (sessionFic != NULL)) {
+        return;
+    }
+    if (strlen (nFic) >= sizeof (sessionName)) {
+        fprintf (stderr, "log file name is too long!\n");
+        exit (EXIT_FAILURE);
+    }
+    strcpy (sessionName, nFic);
+    if ((sessionFic = fopen (sessionName, "a")) == NULL) {
+        perror ("error on opening log file");
+        exit (EXIT_FAILURE);
+    }
+    if (setvbuf (sessionFic, sessionBuf, _IOFBF, LOGBUFSIZE) != 0) {
+        perror ("error on setting the log file buffer");
+        exit (EXIT_FAILURE);
+    }
+}
+
+/**
+ *  \brief Setting the logging level of the process.
+ *
+ *  Below <tt>LOG_LEVEL_FULL</tt> the lines of state are not logged and below <tt>LOG_LEVEL_EVENTS</tt> the flight
+ *  events are not logged either; the corresponding logging operations return at once, before building the event
+ *  record. The title and the summary of the air lift are always logged.
+ *
+ *  \param level logging level (<tt>LOG_LEVEL_SUMMARY</tt>, <tt>LOG_LEVEL_EVENTS</tt> or <tt>LOG_LEVEL_FULL</tt>)
+ */
+
+void setLogLevel (unsigned int level)
+{
+    logLevel = level;
+}
+
+/**
+ *  \brief Getting the logging level of the process.
+ *
+ *  \return logging level (<tt>LOG_LEVEL_SUMMARY</tt>, <tt>LOG_LEVEL_EVENTS</tt> or <tt>LOG_LEVEL_FULL</tt>)
+ */
+
+unsigned int getLogLevel (void)
+{
+    return logLevel;
+}
+
+/**
+ *  \brief Setting the clock the event records of the process are time stamped with.
+ *
+ *  \param clk function returning the present time in ns (NULL, for the monotonic clock)
+ */
+
+void setLogClock (unsigned long long (*clk) (void))
+{
+    logClock = clk;
+}
+
+/**
+ *  \brief Flushing of the log session.
+ *
+ *  Any line still held in the user-space buffer is written to the logging file.
+ *  In the deferred build, the records kept by the process are printed into the spool file; it should be called
+ *  outside of the critical region.
+ */
+
+void flushLog (void)
+{
+#ifdef LOG_DEFERRED
+    flushPending ();
+#endif
+    if ((sessionFic != NULL) && (fflush (sessionFic) == EOF)) {
+        perror ("error on flushing the log file");
+        exit (EXIT_FAILURE);
+    }
+}
+
+/**
+ *  \brief Closing of the log session.
+ *
+ *  The buffer is flushed and the logging file kept open by the session is closed.
+ *  In the binary build, the process that created the logging file also writes the records still held in the
+ *  event ring; it must be the last one to log.
+ *  In the deferred build, the process that created the logging file also merges the spool file into it, in sequence
+ *  order; it must be the last one to log.
+ *  In the asynchronous build, the process that created the logging file also tells the logger process that no
+ *  more records will be pushed; it must be the last one to log.
+ */
+
+void closeLogSession (void)
+{
+#ifdef LOG_BINARY
+    if (logOwner && (sessionShared != NULL)) {
+        drainRing ();
+    }
+#elif defined (LOG_ASYNC)
+    if (logOwner && (sessionShared != NULL)) {
+        __atomic_store_n (&sessionShared->qDone, 1, __ATOMIC_RELEASE);
+    }
+#elif defined (LOG_DEFERRED)
+    if (spoolFd != -1) {
+        flushPending ();
+        if (logOwner && (sessionShared != NULL)) {
+            mergeSpool ((sessionFic != NULL) ? sessionFic : stdout);
+            unlink (spoolName);
+        }
+        close (spoolFd);
+        spoolFd = -1;
+        free (spoolChunk);
+        spoolChunk = NULL;
+    }
+#endif
+    sessionShared = NULL;
+    if (sessionFic == NULL) {
+        return;
+    }
+    if (fclose (sessionFic) == EOF) {
+        perror ("error on closing of log file");
+        exit (EXIT_FAILURE);
+    }
+    sessionFic = NULL;
+}
+
 /**
  *  \brief File initialization.
  *
@@ -87,6 +877,8 @@ static void printHeader(FILE *fic)
  *       \li a title line
  *       \li a blank line.
  *
+ *  In the binary build, the file header is a <tt>LOG_FILE_HDR</tt> record instead.
+ *
  *  \param nFic name of the logging file
  */
 
@@ -95,13 +887,113 @@ void createLog (char nFic[])
     FILE *fic;                                                                                      /* file descriptor */
 
     fic = openLog(nFic,"w");
+    logOwner = true;
 
+#ifdef LOG_BINARY
+    LOG_FILE_HDR hdr;                                                                           /* binary file header */
+
+    memset (&hdr, 0, sizeof (hdr));
+    strcpy (hdr.magic, LOGMAGIC);
+    hdr.n = N;
+    hdr.recSize = sizeof (LOG_REC);
+    if (fwrite (&hdr, sizeof (hdr), 1, fic) != 1) {
+        perror ("error on writing the log file header");
+        exit (EXIT_FAILURE);
+    }
+#else
     /* title line + blank line */
 
+    printTitle (fic);
+#endif
+#ifdef LOG_DEFERRED
+    char name[sizeof (spoolName)];                                                         /* name of the spool file */
+
+    spoolFileName (nFic, name);
+    if ((unlink (name) == -1) && (errno != ENOENT)) {                               /* discard an old spool file */
+        perror ("error on removing the spool file");
+        exit (EXIT_FAILURE);
+    }
+#endif
+
+    closeLog(fic);
+}
+
+/**
+ *  \brief Printing the title of the log in text format.
+ *
+ *  \param fic file descriptor
+ */
+
+void printTitle (FILE *fic)
+{
     fprintf (fic, "%31cAir Lift - Description of the internal state\n\n", ' ');
     printHeader(fic);
+}
 
-    closeLog(fic);
+/**
+ *  \brief Printing an event record in text format.
+ *
+ *  The lines are the ones written by the matching logging operation.
+ *  A line of state is patched in place from the previous one printed by the process and written with a single call.
+ *
+ *  \param fic file descriptor
+ *  \param rec pointer to the event record
+ */
+
+void printRecord (FILE *fic, LOG_REC *rec)
+{
+    int p;
+
+    switch (rec->type) {
+    case LOG_STATE:
+        if (renderState (rec)) {
+            fwrite (stateLine, 1, STATELINESIZE, fic);                         /* the whole line in a single call */
+            break;
+        }
+        printStat(fic,3,rec->stat[0]);                                /* some value is wider than its column */
+        printStat(fic,3,rec->stat[1]);
+        fprintf(fic," ");
+        for(p=0; p < N; p++) {
+            printStat(fic,4,rec->stat[p+2]);
+        }
+
+        fprintf(fic," ");
+        fprintf(fic,"%4d",rec->nPassInQueue);
+        fprintf(fic,"%4d",rec->nPassInFlight);
+        fprintf(fic,"%4d",rec->totalPassBoarded);
+
+        fprintf(fic,"\n");
+        break;
+    case LOG_START_BOARDING:
+        fprintf(fic,"Flight %d : Boarding Started\n", rec->nFlight);
+        printHeader(fic);
+        break;
+    case LOG_PASSENGER_CHECKED:
+        fprintf(fic,"Flight %d : Passenger %d checked\n", rec->nFlight, rec->passengerChecked);
+        break;
+    case LOG_FLIGHT_DEPARTED:
+        fprintf(fic,"Flight %d : Departed with %d passengers\n", rec->nFlight, rec->nPassengers);
+        printHeader(fic);
+        break;
+    case LOG_FLIGHT_ARRIVED:
+        fprintf(fic,"Flight %d : Arrived \n", rec->nFlight);
+        printHeader(fic);
+        break;
+    case LOG_FLIGHT_RETURNING:
+        fprintf(fic,"Flight %d : Returning \n", rec->nFlight);
+        printHeader(fic);
+        break;
+    case LOG_AIRLIFT_RESULT:
+        fprintf(fic,"AirLift result\n");
+        fprintf(fic,"AirLift used %d Flights\n", rec->nFlight);
+        break;
+    case LOG_FLIGHT_RESULT:
+        fprintf(fic,"Flight %d took %2d passengers\n", rec->nFlight, rec->nPassengers);
+        break;
+    default:
+        fprintf (stderr, "unknown event record type %u\n", rec->type);
+        break;
+    }
 }
 
 /**
@@ -111,8 +1003,8 @@ void createLog (char nFic[])
  *
  *  The following layout is obeyed for the full state in a single line
  *    \li pilot state
- *    \li hostess state 
- *    \li passengers state 
+ *    \li hostess state
+ *    \li passengers state
  *    \li number of passengers waiting and flying
  *
  *  \param nFic name of the logging file
@@ -121,26 +1013,13 @@ void createLog (char nFic[])
 
 void saveState (char nFic[], FULL_STAT *p_fSt)
 {
-    FILE *fic;                                                                                      /* file descriptor */
+    LOG_REC rec;                                                                                     /* event record */
 
-    fic = openLog(nFic,"a");
-
-    fprintf(fic,"%3d",p_fSt->st.pilotStat);
-    fprintf(fic,"%3d",p_fSt->st.hostessStat);
-    fprintf(fic," ");
-    int p;
-    for(p=0; p < N; p++) {
-        fprintf(fic,"%4d",p_fSt->st.passengerStat[p]);
+    if (logLevel < LOG_LEVEL_FULL) {
+        return;
     }
-
-    fprintf(fic," ");
-    fprintf(fic,"%4d",p_fSt->nPassInQueue);
-    fprintf(fic,"%4d",p_fSt->nPassInFlight);
-    fprintf(fic,"%4d",p_fSt->totalPassBoarded);
-
-    fprintf(fic,"\n");
-
-    closeLog(fic);
+    packRecord (LOG_STATE, p_fSt, &rec);
+    putRecord (nFic, &rec);
 }
 /**
  *  \brief Writing the start of Boarding Process and header.
@@ -153,15 +1032,13 @@ void saveState (char nFic[], FULL_STAT *p_fSt)
 
 void saveStartBoarding (char nFic[], FULL_STAT *p_fSt)
 {
-    FILE *fic;                                                                                      /* file descriptor */
-
-    fic = openLog(nFic,"a");
+    LOG_REC rec;                                                                                     /* event record */
 
-    fprintf(fic,"Flight %d : Boarding Started\n", p_fSt->nFlight);
-    printHeader(fic);
-
-
-    closeLog(fic);
+    if (logLevel < LOG_LEVEL_EVENTS) {
+        return;
+    }
+    packRecord (LOG_START_BOARDING, p_fSt, &rec);
+    putRecord (nFic, &rec);
 }
 
 /**
@@ -175,13 +1052,13 @@ void saveStartBoarding (char nFic[], FULL_STAT *p_fSt)
 
 void savePassengerChecked (char nFic[], FULL_STAT *p_fSt)
 {
-    FILE *fic;                                                                                      /* file descriptor */
+    LOG_REC rec;                                                                                     /* event record */
 
-    fic = openLog(nFic,"a");
-
-    fprintf(fic,"Flight %d : Passenger %d checked\n", p_fSt->nFlight, p_fSt->passengerChecked);
-
-    closeLog(fic);
+    if (logLevel < LOG_LEVEL_EVENTS) {
+        return;
+    }
+    packRecord (LOG_PASSENGER_CHECKED, p_fSt, &rec);
+    putRecord (nFic, &rec);
 }
 
 /**
@@ -195,21 +1072,20 @@ void savePassengerChecked (char nFic[], FULL_STAT *p_fSt)
 
 void saveFlightDeparted (char nFic[], FULL_STAT *p_fSt)
 {
-    FILE *fic;                                                                                      /* file descriptor */
+    LOG_REC rec;                                                                                     /* event record */
 
-    fic = openLog(nFic,"a");
-
-    fprintf(fic,"Flight %d : Departed with %d passengers\n", p_fSt->nFlight, p_fSt->nPassengersInFlight[p_fSt->nFlight-1]);
-    printHeader(fic);
-
-    closeLog(fic);
+    if (logLevel < LOG_LEVEL_EVENTS) {
+        return;
+    }
+    packRecord (LOG_FLIGHT_DEPARTED, p_fSt, &rec);
+    putRecord (nFic, &rec);
 }
 
 
 /**
  *  \brief Writing the flight arrival at the end of the file.
  *
- *  If <tt>nFic</tt> is a null pointer or a null string, the lines are written to stdout 
+ *  If <tt>nFic</tt> is a null pointer or a null string, the lines are written to stdout
  *
  *  \param nFic name of the logging file
  *  \param p_fSt pointer to the location where the full internal state of the problem is stored
@@ -217,20 +1093,19 @@ void saveFlightDeparted (char nFic[], FULL_STAT *p_fSt)
 
 void saveFlightArrived (char nFic[], FULL_STAT *p_fSt)
 {
-    FILE *fic;                                                                                      /* file descriptor */
+    LOG_REC rec;                                                                                     /* event record */
 
-    fic = openLog(nFic,"a");
-
-    fprintf(fic,"Flight %d : Arrived \n", p_fSt->nFlight);
-    printHeader(fic);
-
-    closeLog(fic);
+    if (logLevel < LOG_LEVEL_EVENTS) {
+        return;
+    }
+    packRecord (LOG_FLIGHT_ARRIVED, p_fSt, &rec);
+    putRecord (nFic, &rec);
 }
 
 /**
  *  \brief Writing the flight returning at end of file.
  *
- *  If <tt>nFic</tt> is a null pointer or a null string, the lines are written to stdout 
+ *  If <tt>nFic</tt> is a null pointer or a null string, the lines are written to stdout
  *
  *  \param nFic name of the logging file
  *  \param p_fSt pointer to the location where the full internal state of the problem is stored
@@ -238,20 +1113,19 @@ void saveFlightArrived (char nFic[], FULL_STAT *p_fSt)
 
 void saveFlightReturning (char nFic[], FULL_STAT *p_fSt)
 {
-    FILE *fic;                                                                                      /* file descriptor */
+    LOG_REC rec;                                                                                     /* event record */
 
-    fic = openLog(nFic,"a");
-
-    fprintf(fic,"Flight %d : Returning \n", p_fSt->nFlight);
-    printHeader(fic);
-
-    closeLog(fic);
+    if (logLevel < LOG_LEVEL_EVENTS) {
+        return;
+    }
+    packRecord (LOG_FLIGHT_RETURNING, p_fSt, &rec);
+    putRecord (nFic, &rec);
 }
 
 /**
  *  \brief Writing summary of air lift at the end of the file.
  *
- *  If <tt>nFic</tt> is a null pointer or a null string, the lines are written to stdout 
+ *  If <tt>nFic</tt> is a null pointer or a null string, the lines are written to stdout
  *
  *  \param nFic name of the logging file
  *  \param p_fSt pointer to the location where the full internal state of the problem is stored
@@ -259,16 +1133,16 @@ void saveFlightReturning (char nFic[], FULL_STAT *p_fSt)
 
 void saveAirLiftResult (char nFic[], FULL_STAT *p_fSt)
 {
-    FILE *fic;                                                                                      /* file descriptor */
-    fic = openLog(nFic,"a");
+    LOG_REC rec;                                                                                     /* event record */
 
-    fprintf(fic,"AirLift result\n");
+    packRecord (LOG_AIRLIFT_RESULT, p_fSt, &rec);
+    putRecord (nFic, &rec);
 
     int f;
-    fprintf(fic,"AirLift used %d Flights\n", p_fSt->nFlight);
     for(f=0; f<p_fSt->nFlight; f++) {
-        fprintf(fic,"Flight %d took %2d passengers\n", f+1, p_fSt->nPassengersInFlight[f]);
+        rec.type = LOG_FLIGHT_RESULT;
+        rec.nFlight = f+1;
+        rec.nPassengers = p_fSt->nPassengersInFlight[f];
+        putRecord (nFic, &rec);
     }
-
-    closeLog(fic);
 }
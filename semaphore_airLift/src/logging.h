@@ -6,13 +6,26 @@
  *  \brief Logging the internal state of the problem into a file.
  *
  *  Defined operations:
+ *     \li opening, flushing and closing of the log session
  *     \li file initialization
  *     \li writing the start of boarding at the end of the file
  *     \li writing the start of flight at end of the file.
  *     \li writing the present full state as a single line at the end of the file.
  *     \li Writing the flight arrival at the end of the file.
  *     \li Writing the flight returning at the end of the file.
- *     \li writing summary of air lift at the end of the file.
+ *     \li writing summary of air lift at the end of the file
+ *     \li printing a logging event record in text format.
+ *
+ *  Every logging operation is described by a fixed-size event record.
+ *  When compiled with <tt>LOG_BINARY</tt>, the records are gathered in an event ring in shared memory and the
+ *  logging file holds them in binary format; the <em>logDecoder</em> tool rebuilds the text log.
+ *  When compiled with <tt>LOG_DEFERRED</tt>, the records are only numbered and kept by the calling process inside the
+ *  critical region; they are printed later, outside of it, into a spool file which is merged in sequence order
+ *  into the logging file at the end of the session.
+ *  In the delta format, a line of state shows "." for every entity whose state did not change since the previous
+ *  line, as the <em>filter_log.awk</em> script did; the <em>logExpand</em> tool restores the full format.
+ *  When compiled with <tt>LOG_ASYNC</tt>, the records are pushed into a lock-free queue in shared memory and a
+ *  dedicated logger process, the only writer of the logging file, prints them in large blocks.
  *
  *  \author Nuno Lau - January 2022
  */
@@ -20,8 +33,226 @@
 #ifndef LOGGING_H_
 #define LOGGING_H_
 
+#include <stdio.h>
+
 #include "probDataStruct.h"
 
+/* Logging event types */
+
+/** \brief present full state as a single line */
+#define  LOG_STATE                    0
+/** \brief start of boarding */
+#define  LOG_START_BOARDING           1
+/** \brief passenger passport checked */
+#define  LOG_PASSENGER_CHECKED        2
+/** \brief flight departed */
+#define  LOG_FLIGHT_DEPARTED          3
+/** \brief flight arrived */
+#define  LOG_FLIGHT_ARRIVED           4
+/** \brief flight returning */
+#define  LOG_FLIGHT_RETURNING         5
+/** \brief summary of air lift */
+#define  LOG_AIRLIFT_RESULT           6
+/** \brief number of passengers of one flight in the summary of air lift */
+#define  LOG_FLIGHT_RESULT            7
+
+/* Logging formats */
+
+/** \brief every line of state shows all the values */
+#define  LOG_FULL                     0
+/** \brief a line of state shows "." for an entity whose state did not change since the previous line */
+#define  LOG_DELTA                    1
+
+/* Logging levels */
+
+/** \brief only the summary of the air lift is logged */
+#define  LOG_LEVEL_SUMMARY            0
+/** \brief the flight events and the summary of the air lift are logged */
+#define  LOG_LEVEL_EVENTS             1
+/** \brief everything is logged, the lines of state included (default) */
+#define  LOG_LEVEL_FULL               2
+
+/** \brief packed state of an entity that did not change since the previous line of state (delta format) */
+#define  LOG_UNCHANGED              255
+
+/** \brief number of event records held in the event ring */
+#define  LOGRINGSIZE               1024
+
+/** \brief number of slots of the queue of event records (power of 2) */
+#define  LOGQUEUESIZE              1024
+
+/** \brief identification of a binary logging file */
+#define  LOGMAGIC             "AIRLIFT"
+
+/**
+ *  \brief Definition of <em>logging event record</em> data type.
+ */
+typedef struct
+{ /** \brief event type */
+    unsigned int type;
+    /** \brief sequence number of the event */
+    unsigned int seq;
+    /** \brief flight number */
+    unsigned int nFlight;
+    /** \brief number of passengers waiting */
+    unsigned int nPassInQueue;
+    /** \brief number of passengers flying */
+    unsigned int nPassInFlight;
+    /** \brief total number of passengers already boarded in every flight */
+    unsigned int totalPassBoarded;
+    /** \brief passenger id of last passenger to check passport */
+    int passengerChecked;
+    /** \brief number of passengers of the flight the event refers to */
+    unsigned int nPassengers;
+    /** \brief time stamp (monotonic clock, in ns) */
+    unsigned long long time;
+    /** \brief packed state of the intervening entities: pilot, hostess and passengers */
+    unsigned char stat[N+2];
+
+} LOG_REC;
+
+/**
+ *  \brief Definition of <em>binary logging file header</em> data type.
+ */
+typedef struct
+{ /** \brief identification of the file format */
+    char magic[8];
+    /** \brief number of passengers */
+    unsigned int n;
+    /** \brief size of an event record (in bytes) */
+    unsigned int recSize;
+
+} LOG_FILE_HDR;
+
+/**
+ *  \brief Definition of <em>slot of the queue of event records</em> data type.
+ */
+typedef struct
+{ /** \brief position in the queue the slot is ready for: to be filled at <tt>turn</tt>, to be emptied at
+      <tt>turn - 1</tt> */
+    unsigned int turn;
+    /** \brief event record */
+    LOG_REC rec;
+
+} LOG_SLOT;
+
+/**
+ *  \brief Definition of <em>logging data shared by the intervening entities</em> data type.
+ */
+typedef struct
+{ /** \brief logging format (<tt>LOG_FULL</tt> or <tt>LOG_DELTA</tt>), set before the session is opened */
+    unsigned int format;
+    /** \brief packed state of the entities in the previous line of state (delta format) */
+    unsigned char lastStat[N+2];
+    /** \brief sequence number of the next event */
+    unsigned int seq;
+    /** \brief number of records held in the event ring */
+    unsigned int nRec;
+#ifdef LOG_BINARY
+    /** \brief event ring */
+    LOG_REC ring[LOGRINGSIZE];
+#endif
+#ifdef LOG_ASYNC
+    /** \brief position of the next record to be pushed into the queue */
+    unsigned int qTail;
+    /** \brief position of the next record to be taken from the queue (logger only) */
+    unsigned int qHead;
+    /** \brief no more records will be pushed into the queue */
+    unsigned int qDone;
+    /** \brief queue of event records (many producers, one consumer) */
+    LOG_SLOT queue[LOGQUEUESIZE];
+#endif
+
+} LOG_SHARED;
+
+/**
+ *  \brief Opening of the log session.
+ *
+ *  The logging file is opened once, in append mode, and kept open until the session is closed, so that the
+ *  following logging operations on the same file do not have to open and close it each time.
+ *  A large user-space buffer is attached to the file.
+ *  If <tt>nFic</tt> is a null pointer or a null string, the lines keep being written to stdout.
+ *  In the asynchronous build, the file is left to the logger process and the process that created the logging
+ *  file sets up the empty queue of event records.
+ *
+ *  \param nFic name of the logging file
+ *  \param p_log pointer to the logging data shared by all the intervening entities
+ */
+
+extern void openLogSession (char nFic[], LOG_SHARED *p_log);
+
+/**
+ *  \brief Setting the logging level of the process.
+ *
+ *  Below <tt>LOG_LEVEL_FULL</tt> the lines of state are not logged and below <tt>LOG_LEVEL_EVENTS</tt> the flight
+ *  events are not logged either; the corresponding logging operations return at once, before building the event
+ *  record. The title and the summary of the air lift are always logged.
+ *
+ *  \param level logging level (<tt>LOG_LEVEL_SUMMARY</tt>, <tt>LOG_LEVEL_EVENTS</tt> or <tt>LOG_LEVEL_FULL</tt>)
+ */
+
+extern void setLogLevel (unsigned int level);
+
+/**
+ *  \brief Getting the logging level of the process.
+ *
+ *  \return logging level (<tt>LOG_LEVEL_SUMMARY</tt>, <tt>LOG_LEVEL_EVENTS</tt> or <tt>LOG_LEVEL_FULL</tt>)
+ */
+
+extern unsigned int getLogLevel (void);
+
+/**
+ *  \brief Setting the clock the event records of the process are time stamped with.
+ *
+ *  By default, the records are time stamped with the monotonic clock; a simulation on a virtual clock sets its own.
+ *
+ *  \param clk function returning the present time in ns (NULL, for the monotonic clock)
+ */
+
+extern void setLogClock (unsigned long long (*clk) (void));
+
+/**
+ *  \brief Flushing of the log session.
+ *
+ *  Any line still held in the user-space buffer is written to the logging file.
+ *  In the deferred build, the records kept by the process are printed into the spool file; it should be called
+ *  outside of the critical region.
+ */
+
+extern void flushLog (void);
+
+/**
+ *  \brief Closing of the log session.
+ *
+ *  The buffer is flushed and the logging file kept open by the session is closed.
+ *  In the binary build, the process that created the logging file also writes the records still held in the
+ *  event ring; it must be the last one to log.
+ *  In the deferred build, the process that created the logging file also merges the spool file into it, in sequence
+ *  order; it must be the last one to log.
+ *  In the asynchronous build, the process that created the logging file also tells the logger process that no
+ *  more records will be pushed; it must be the last one to log.
+ */
+
+extern void closeLogSession (void);
+
+#ifdef LOG_ASYNC
+
+/**
+ *  \brief Service of the logger process.
+ *
+ *  The event records are taken from the queue, in the order they were pushed, printed into a large buffer and
+ *  written to the logging file when the buffer is full or the queue is empty.
+ *  The function returns when the queue is empty and no more records will be pushed.
+ *  If <tt>nFic</tt> is a null pointer or a null string, the lines are written to stdout.
+ *
+ *  \param nFic name of the logging file
+ *  \param p_log pointer to the logging data shared by all the intervening entities
+ */
+
+extern void serveLog (char nFic[], LOG_SHARED *p_log);
+
+#endif
+
 /**
  *  \brief File initialization.
  *
@@ -32,11 +263,44 @@
  *       \li a title line
  *       \li a blank line.
  *
+ *  In the binary build, the file header is a <tt>LOG_FILE_HDR</tt> record instead.
+ *
  *  \param nFic name of the logging file
  */
 
 extern void createLog (char nFic[]);
 
+/**
+ *  \brief Printing the title of the log in text format.
+ *
+ *  \param fic file descriptor
+ */
+
+extern void printTitle (FILE *fic);
+
+/**
+ *  \brief Printing an event record in text format.
+ *
+ *  The lines are the ones written by the matching logging operation.
+ *
+ *  \param fic file descriptor
+ *  \param rec pointer to the event record
+ */
+
+extern void printRecord (FILE *fic, LOG_REC *rec);
+
+/**
+ *  \brief Marking the entities of an event record of state whose state did not change (delta format).
+ *
+ *  The packed state of those entities is replaced by <tt>LOG_UNCHANGED</tt>, which is printed as ".".
+ *  Records of other types are left untouched.
+ *
+ *  \param rec pointer to the event record
+ *  \param last packed state of the entities in the previous line of state, updated with the new one
+ */
+
+extern void markUnchanged (LOG_REC *rec, unsigned char last[]);
+
 /**
  *  \brief Writing the start of Boarding Process and header.
  *
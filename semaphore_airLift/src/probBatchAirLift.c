@@ -0,0 +1,346 @@
+/**
+ *  \file probBatchAirLift.c (implementation file)
+ *
+ *  \brief Problem name: Air Lift.
+ *
+ *  Batch driver of the simulation.
+ *
+ *  The generator is run a number of times, several runs at a time. Each run takes its own access key to the shared
+ *  region and the semaphore set from the registry of the working directory (see <tt>ipcRegistry.h</tt>) and has
+ *  its own logging file, <em>directory</em><tt>/log_</tt><em>run</em>, so the runs do not interfere. When a run
+ *  terminates, the summary of the air lift written at its end by <tt>saveAirLiftResult</tt> is read from its
+ *  logging file through <tt>logReader</tt> and aggregated: the flights used per run and the distribution of the
+ *  passengers per flight are printed to stdout at the end.
+ *
+ *  The runs spend most of their time sleeping, so running more of them at a time than there are processors still
+ *  pays off.
+ *
+ *  Upon execution, the following parameters are accepted:
+ *    \li <tt>-n runs</tt>: number of runs (<tt>NRUNS</tt>, by default)
+ *    \li <tt>-j runs</tt>: number of runs at a time (number of online processors, by default; up to
+ *        <tt>MAXJOBS</tt>)
+ *    \li <tt>-o directory</tt>: directory of the logging files (<tt>LOGDIR</tt>, by default; created if absent)
+ *    \li <tt>-x program</tt>: generator (<tt>GENERATOR</tt>, by default; e.g. <tt>./probSemThreadAirLift</tt>)
+ *    \li <tt>-d</tt> and <tt>-l level</tt>: passed to the generator (the summary is logged at every level, but not
+ *        in binary format).
+ *
+ *  The exit status is \c EXIT_FAILURE if any run failed or its summary could not be read.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+#include "probConst.h"
+#include "logReader.h"
+
+/** \brief default generator */
+#define  GENERATOR     "./probSemSharedMemAirLift"
+
+/** \brief default number of runs */
+#define  NRUNS         1000
+
+/** \brief default directory of the logging files */
+#define  LOGDIR        "batch"
+
+/** \brief largest number of runs at a time (the number of candidate keys of the generator) */
+#define  MAXJOBS       64
+
+/** \brief largest size of the name of a logging file accepted by the generator */
+#define  NAMELEN       50
+
+/**
+ *  \brief Definition of <em>aggregated results</em> data type.
+ */
+typedef struct
+{ /** \brief number of runs whose generator terminated successfully */
+    unsigned long nDone;
+    /** \brief number of runs whose generator failed */
+    unsigned long nFailed;
+    /** \brief number of runs whose summary could not be read */
+    unsigned long nUnread;
+    /** \brief number of flights of all the runs read */
+    unsigned long nFlights;
+    /** \brief fewest flights of a run */
+    unsigned long minFlights;
+    /** \brief most flights of a run */
+    unsigned long maxFlights;
+    /** \brief number of flights that took n passengers, for n = 0 .. MAXFC */
+    unsigned long perFlight[MAXFC+1];
+    /** \brief number of flights that took a number of passengers out of 0 .. MAXFC */
+    unsigned long outOfRange;
+
+} BATCH_RESULT;
+
+/**
+ *  \brief Getting the present time in ms.
+ */
+
+static long long nowMs (void)
+{
+    struct timespec t;
+
+    clock_gettime (CLOCK_MONOTONIC, &t);
+    return (long long) t.tv_sec * 1000 + t.tv_nsec / 1000000;
+}
+
+/**
+ *  \brief Reading the summary of a run from its logging file and adding it to the results.
+ *
+ *  The last summary of the file is taken.
+ *
+ *  \param nFic name of the logging file
+ *  \param res pointer to the results
+ *
+ *  \return true, if the summary was read, false, otherwise
+ */
+
+static bool addSummary (const char *nFic, BATCH_RESULT *res)
+{
+    LOG_READER lr;
+    LOG_LINE line;
+    unsigned long took[MAXFC+1];                                        /* flights that took n passengers in the run */
+    unsigned long nTook = 0, outOfRange = 0;
+    int used = -1;                                                           /* flights used (-1, if not read yet) */
+    int n;
+
+    if (logReaderOpen (&lr, nFic) == -1) {
+        return false;
+    }
+    while (logReaderNext (&lr, &line)) {
+        switch (line.kind) {
+        case LINE_RESULT:
+            memset (took, 0, sizeof (took));
+            nTook = outOfRange = 0;
+            used = -1;
+            break;
+        case LINE_USED:
+            used = line.value;
+            break;
+        case LINE_TOOK:
+            if ((line.value >= 0) && (line.value <= MAXFC)) {
+                took[line.value] += 1;
+            }
+            else outOfRange += 1;
+            nTook += 1;
+            break;
+        }
+    }
+    logReaderClose (&lr);
+    if ((used < 0) || (nTook != (unsigned long) used)) {
+        return false;
+    }
+
+    if ((res->nFlights == 0) || ((unsigned long) used < res->minFlights)) {
+        res->minFlights = (unsigned long) used;
+    }
+    if ((unsigned long) used > res->maxFlights) {
+        res->maxFlights = (unsigned long) used;
+    }
+    res->nFlights += (unsigned long) used;
+    for (n = 0; n <= MAXFC; n++) {
+        res->perFlight[n] += took[n];
+    }
+    res->outOfRange += outOfRange;
+    return true;
+}
+
+/**
+ *  \brief Printing the aggregated results.
+ *
+ *  \param fp stream they are printed to
+ *  \param res pointer to the results
+ */
+
+static void printResult (FILE *fp, const BATCH_RESULT *res)
+{
+    unsigned long nRead = res->nDone - res->nUnread;
+    int n;
+
+    fprintf (fp, "Runs: %lu completed, %lu failed, %lu without summary\n", res->nDone, res->nFailed, res->nUnread);
+    if (nRead == 0) {
+        return;
+    }
+    fprintf (fp, "Flights per run: min %lu, mean %.2f, max %lu (%lu flights in all)\n", res->minFlights,
+             (double) res->nFlights / nRead, res->maxFlights, res->nFlights);
+    fprintf (fp, "Passengers per flight:\n");
+    for (n = 0; n <= MAXFC; n++) {
+        if (res->perFlight[n] > 0) {
+            fprintf (fp, "  %2d: %8lu flights (%6.2f%%)\n", n, res->perFlight[n],
+                     100.0 * res->perFlight[n] / res->nFlights);
+        }
+    }
+    if (res->outOfRange > 0) {
+        fprintf (fp, "  out of 0..%d: %lu flights\n", MAXFC, res->outOfRange);
+    }
+}
+
+/**
+ *  \brief Starting a run.
+ *
+ *  \param gen generator
+ *  \param nFic name of the logging file of the run
+ *  \param delta log the lines of state in the delta format
+ *  \param level logging level argument (NULL, if none)
+ *
+ *  \return process identifier of the generator
+ */
+
+static pid_t startRun (const char *gen, const char *nFic, bool delta, const char *level)
+{
+    const char *arg[6];
+    int a = 0;
+    pid_t pid;
+
+    arg[a++] = gen;
+    if (delta) {
+        arg[a++] = "-d";
+    }
+    if (level != NULL) {
+        arg[a++] = "-l";
+        arg[a++] = level;
+    }
+    arg[a++] = nFic;
+    arg[a] = NULL;
+
+    if ((pid = fork ()) < 0) {
+        perror ("error on the fork operation for a run");
+        exit (EXIT_FAILURE);
+    }
+    if (pid == 0) {
+        execv (gen, (char *const *) arg);
+        perror ("error on the generation of the generator process");
+        exit (EXIT_FAILURE);
+    }
+    return pid;
+}
+
+/**
+ *  \brief Main program.
+ *
+ *  Its role is running the generator the given number of times, keeping the given number of runs going on, and
+ *  aggregating their summaries.
+ */
+
+int main (int argc, char *argv[])
+{
+    const char *gen = GENERATOR;                                                                         /* generator */
+    const char *dir = LOGDIR;                                                          /* directory of the logging files */
+    const char *level = NULL;                                                      /* logging level (NULL, if default) */
+    bool delta = false;                                                                        /* delta format of logs */
+    long nRuns = NRUNS;                                                                               /* number of runs */
+    long nJobs = sysconf (_SC_NPROCESSORS_ONLN);                                             /* number of runs at a time */
+    pid_t pid[MAXJOBS],                                                      /* generator of every slot (0, if free) */
+          info;
+    long run[MAXJOBS];                                                                           /* run of every slot */
+    char nFic[NAMELEN+1];                                                                    /* name of a logging file */
+    BATCH_RESULT res;
+    long next = 0, nRunning = 0;
+    long long start;
+    double wall;
+    int status, s, opt;
+    char *tinp;
+
+    while ((opt = getopt (argc, argv, "dj:l:n:o:x:")) != -1) {
+        switch (opt) {
+        case 'd':
+            delta = true;
+            break;
+        case 'j':
+            nJobs = strtol (optarg, &tinp, 0);
+            if ((*tinp != '\0') || (nJobs < 1) || (nJobs > MAXJOBS)) {
+                fprintf (stderr, "Invalid number of runs at a time (1 .. %d)!\n", MAXJOBS);
+                return EXIT_FAILURE;
+            }
+            break;
+        case 'l':
+            level = optarg;
+            break;
+        case 'n':
+            nRuns = strtol (optarg, &tinp, 0);
+            if ((*tinp != '\0') || (nRuns < 1)) {
+                fprintf (stderr, "Invalid number of runs!\n");
+                return EXIT_FAILURE;
+            }
+            break;
+        case 'o':
+            dir = optarg;
+            break;
+        case 'x':
+            gen = optarg;
+            break;
+        default:
+            fprintf (stderr, "Usage: %s [-n runs] [-j runs at a time] [-o directory] [-x generator] [-d] "
+                     "[-l full|events|summary]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (nJobs > MAXJOBS) {
+        nJobs = MAXJOBS;
+    }
+    if (nJobs > nRuns) {
+        nJobs = nRuns;
+    }
+    if (snprintf (nFic, sizeof (nFic), "%s/log_%04ld", dir, nRuns) >= (int) sizeof (nFic)) {
+        fprintf (stderr, "The directory name is too long!\n");
+        return EXIT_FAILURE;
+    }
+    if ((mkdir (dir, 0777) == -1) && (errno != EEXIST)) {
+        perror ("error on creating the directory of the logging files");
+        return EXIT_FAILURE;
+    }
+    for (s = 0; s < nJobs; s++) {
+        pid[s] = 0;
+    }
+    memset (&res, 0, sizeof (res));
+
+    /* keeping nJobs runs going on, aggregating the summary of every run that terminates */
+
+    start = nowMs ();
+    while ((next < nRuns) || (nRunning > 0)) {
+        for (s = 0; (s < nJobs) && (next < nRuns); s++) {
+            if (pid[s] == 0) {
+                run[s] = ++next;
+                sprintf (nFic, "%s/log_%04ld", dir, run[s]);
+                pid[s] = startRun (gen, nFic, delta, level);
+                nRunning += 1;
+            }
+        }
+        info = wait (&status);
+        if (info == -1) {
+            perror ("error on waiting for a run");
+            return EXIT_FAILURE;
+        }
+        for (s = 0; (s < nJobs) && (pid[s] != info); s++) {
+        }
+        if (s == nJobs) {
+            continue;
+        }
+        pid[s] = 0;
+        nRunning -= 1;
+        sprintf (nFic, "%s/log_%04ld", dir, run[s]);
+        if (!WIFEXITED (status) || (WEXITSTATUS (status) != EXIT_SUCCESS)) {
+            fprintf (stderr, "Run %ld failed (logging file %s)\n", run[s], nFic);
+            res.nFailed += 1;
+            continue;
+        }
+        res.nDone += 1;
+        if (!addSummary (nFic, &res)) {
+            fprintf (stderr, "Run %ld: the summary could not be read from %s\n", run[s], nFic);
+            res.nUnread += 1;
+        }
+    }
+    wall = (double) (nowMs () - start) / 1000.0;
+
+    printResult (stdout, &res);
+    printf ("%ld runs in %.2f s (%.1f runs per s), %ld at a time\n", nRuns, wall, nRuns / wall, nJobs);
+
+    return ((res.nFailed > 0) || (res.nUnread > 0)) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -13,8 +13,10 @@
 
 /* Generic parameters */
 
-/** \brief number of passengers */
-#define  N        21 
+/** \brief number of passengers (may be overridden at build time, as the layout benchmark does) */
+#ifndef N
+#define  N        21
+#endif
 
 /** \brief min flight capacity */
 #define  MINFC     5 
@@ -22,8 +24,10 @@
 /** \brief max flight capacity */
 #define  MAXFC    10
 
-/** \brief max flight capacity */
+/** \brief max number of flights (may be overridden at build time, for a larger number of passengers) */
+#ifndef MAXNF
 #define  MAXNF    10
+#endif
 
 /** \brief max flight capacity */
 #define  MAXTRAVEL   30000.0 
@@ -7,6 +7,12 @@
  *
  *  They specify internal metadata about the status of the intervening entities.
  *
+ *  When compiled with <tt>LAYOUT_PADDED</tt> defined, the fields written by different entities are aligned on
+ *  separate cache lines: the pilot state, the hostess state, the passengers state array (so every group of
+ *  <tt>CACHELINE / sizeof (unsigned int)</tt> passengers owns its lines), the flight data and each of the counters.
+ *  A process that updates its own field then does not invalidate the line another process is working on.
+ *  The field names are the same in both layouts.
+ *
  *  \author Nuno Lau - January 2022
  */
 
@@ -14,20 +20,45 @@
 #define PROBDATASTRUCT_H_
 
 #include <stdbool.h>
+#ifdef ATOMIC_COUNTERS
+#include <stdatomic.h>
+#endif
 
 #include "probConst.h"
 
+/** \brief size of a cache line (in bytes) */
+#define  CACHELINE       64
+
+/** \brief alignment of a field that starts a cache line of its own (padded layout only) */
+#ifdef LAYOUT_PADDED
+#define  CACHE_ALIGNED   __attribute__ ((aligned (CACHELINE)))
+#else
+#define  CACHE_ALIGNED
+#endif
+
+/**
+ *  \brief Definition of <em>counter of passengers</em> data type.
+ *
+ *  When compiled with <tt>ATOMIC_COUNTERS</tt> defined, the counters of passengers in queue, in flight and boarded
+ *  are atomic, so that every update is an atomic read-modify-write and they may be updated outside the critical
+ *  region where no invariant among several fields is at stake (see <tt>semSharedMemPassenger.c</tt>).
+ */
+#ifdef ATOMIC_COUNTERS
+typedef atomic_uint PASS_COUNTER;
+#else
+typedef unsigned int PASS_COUNTER;
+#endif
 
 /**
  *  \brief Definition of <em>state of the intervening entities</em> data type.
  */
 typedef struct
 { /** \brief pilot state */
-    unsigned int pilotStat;
+    unsigned int pilotStat CACHE_ALIGNED;
     /** \brief hostess state */
-    unsigned int hostessStat;
+    unsigned int hostessStat CACHE_ALIGNED;
     /** \brief passengers state array */
-    unsigned int passengerStat[N];
+    unsigned int passengerStat[N] CACHE_ALIGNED;
 
 } STAT;
 
@@ -39,20 +70,20 @@ typedef struct
 { /** \brief state of all intervening entities */
     STAT st;
     /** \brief number of passengers at each flight */
-    unsigned int nPassengersInFlight[MAXNF];
+    unsigned int nPassengersInFlight[MAXNF] CACHE_ALIGNED;
     /** \brief flight number */
     unsigned int nFlight;
 
     /** \brief number of passengers waiting */
-    unsigned int nPassInQueue;
+    PASS_COUNTER nPassInQueue CACHE_ALIGNED;
     /** \brief number of passengers flying */
-    unsigned int nPassInFlight;
+    PASS_COUNTER nPassInFlight CACHE_ALIGNED;
     /** \brief total number of passengers already boarded in every flight */
-    unsigned int totalPassBoarded;
+    PASS_COUNTER totalPassBoarded CACHE_ALIGNED;
     /** \brief air lift finished */
-    bool finished;
+    bool finished CACHE_ALIGNED;
     /** \brief passenger id of last passenger to check passport */
-    int passengerChecked;
+    int passengerChecked CACHE_ALIGNED;
 
 } FULL_STAT;
 
@@ -0,0 +1,451 @@
+/**
+ *  \file probDesAirLift.c (implementation file)
+ *
+ *  \brief Problem name: Air Lift.
+ *
+ *  Discrete-event simulation of the air lift.
+ *
+ *  The pilot, the hostess and the passengers replay the protocol of <tt>semSharedMemPilot.c</tt>,
+ *  <tt>semSharedMemHostess.c</tt> and <tt>semSharedMemPassenger.c</tt> as state machines driven by the engine of
+ *  <tt>desEngine.h</tt>, in a single process: the semaphores the entities wait on are virtual semaphores, the
+ *  critical regions need none, and the flights and the travels to the airport are delays on the virtual clock, drawn
+ *  as the entities draw their sleeping times. The same logging operations are called on the same full state, so the
+ *  log has the same format and passes the same checks; the event records are time stamped with the virtual clock.
+ *
+ *  Upon execution, the following parameters are accepted:
+ *    \li <tt>-d</tt>: log the lines of state in the delta format ("." for the entities whose state did not change)
+ *    \li <tt>-l level</tt>: logging level, <tt>full</tt> (default), <tt>events</tt> (no lines of state) or
+ *        <tt>summary</tt> (only the summary of the air lift)
+ *    \li <tt>-r seed</tt>: seed of the random generator (the process id, by default); a seed always yields the same
+ *        run
+ *    \li name of the logging file (stdout, if absent).
+ *
+ *  The number of passengers is set at build time, as many as memory allows, e.g.
+ *  <tt>make des CFLAGS="-Wall -O2 -DN=1000000 -DMAXNF=200000"</tt>. Every logged event holds the state of all the
+ *  passengers, so with that many only the summary level is practical.
+ *
+ *  The asynchronous build has no logger process to empty the queue of event records and is not supported.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <string.h>
+#include <math.h>
+
+#include "probConst.h"
+#include "probDataStruct.h"
+#include "logging.h"
+#include "desEngine.h"
+
+#ifdef LOG_ASYNC
+#error "the discrete-event simulation does not support asynchronous logging"
+#endif
+
+#if (N + MINFC - 1) / MINFC > MAXNF
+#error "MAXNF is too small for the number of flights of N passengers"
+#endif
+
+/** \brief entity of the hostess (the passengers are entities 0 to N-1) */
+#define  HOSTESS        N
+
+/** \brief entity of the pilot */
+#define  PILOT          (N+1)
+
+/* Steps of the pilot */
+
+/** \brief back at the target: flying to the origin, unless the air lift is finished */
+#define  PT_FLY_BACK    0
+/** \brief landed at the origin: boarding */
+#define  PT_BOARD       1
+/** \brief boarding complete: flying to the target */
+#define  PT_FLY         2
+/** \brief landed at the target: dropping the passengers */
+#define  PT_DROP        3
+/** \brief plane empty: returning */
+#define  PT_RETURN      4
+
+/* Steps of the hostess */
+
+/** \brief waiting for the next flight, unless every passenger was checked */
+#define  HT_FLIGHT      0
+/** \brief ready for boarding: waiting for a passenger */
+#define  HT_PASSENGER   1
+/** \brief passenger in queue: calling the passenger */
+#define  HT_CALL        2
+/** \brief passport shown: checking it */
+#define  HT_CHECK       3
+
+/* Steps of a passenger */
+
+/** \brief at the airport: joining the queue */
+#define  PG_QUEUE       0
+/** \brief called by the hostess: showing the passport */
+#define  PG_SHOW        1
+/** \brief landed at the target: leaving the plane */
+#define  PG_LEAVE       2
+
+/** \brief life cycle over, for any entity */
+#define  OVER         255
+
+/** \brief name of logging file */
+static char nFic[51];
+
+/** \brief full state of the problem */
+static FULL_STAT fSt;
+
+/** \brief logging data of the intervening entities */
+static LOG_SHARED logData;
+
+/** \brief next step of every entity */
+static unsigned char step[N+2];
+
+/** \brief number of entities whose life cycle is over */
+static unsigned int nOver = 0;
+
+/** \brief number of passengers checked by the hostess */
+static unsigned int nChecked = 0;
+
+/* Virtual semaphores, as in sharedDataSync.h (the access semaphore to the critical region is not needed) */
+
+/** \brief hostess waits for passengers */
+static DES_SEM passengersInQueue;
+/** \brief passengers wait for the hostess in queue */
+static DES_SEM passengersWaitInQueue;
+/** \brief passengers wait for the end of the flight */
+static DES_SEM passengersWaitInFlight;
+/** \brief hostess waits for the plane to be ready for boarding */
+static DES_SEM readyForBoarding;
+/** \brief pilot waits for boarding to be complete */
+static DES_SEM readyToFlight;
+/** \brief hostess waits for the passenger to show the passport */
+static DES_SEM idShown;
+/** \brief pilot waits for the last passenger to leave the plane */
+static DES_SEM planeEmpty;
+
+/**
+ *  \brief Getting the virtual clock in ns, to time stamp the event records.
+ */
+
+static unsigned long long virtualNs (void)
+{
+    return desNow () * 1000ULL;
+}
+
+/**
+ *  \brief Drawing the duration of a flight (in us), as the pilot does.
+ */
+
+static unsigned long long flightTime (void)
+{
+    return (unsigned long long) floor ((MAXFLIGHT * random ()) / RAND_MAX + 100.0);
+}
+
+/**
+ *  \brief Drawing the duration of the travel to the airport (in us), as a passenger does.
+ */
+
+static unsigned long long travelTime (void)
+{
+    return (unsigned long long) floor ((MAXTRAVEL * random ()) / RAND_MAX + 1000);
+}
+
+/**
+ *  \brief Running the pilot until it sleeps, blocks or is over.
+ */
+
+static void pilotRun (void)
+{
+    for (;;) {
+        switch (step[PILOT]) {
+        case PT_FLY_BACK:                                                       /* isFinished and flight (false) */
+            if (fSt.finished) {
+                step[PILOT] = OVER;
+                nOver += 1;
+                return;
+            }
+            fSt.st.pilotStat = FLYING_BACK;
+            if (fSt.totalPassBoarded > 0) {
+                saveState (nFic, &fSt);
+            }
+            step[PILOT] = PT_BOARD;
+            desSchedule (PILOT, flightTime ());
+            return;
+        case PT_BOARD:                                       /* signalReadyForBoarding and waitUntilReadyToFlight */
+            fSt.st.pilotStat = READY_FOR_BOARDING;
+            fSt.nFlight += 1;
+            saveState (nFic, &fSt);
+            saveStartBoarding (nFic, &fSt);
+            desUp (&readyForBoarding, 1);
+            fSt.st.pilotStat = WAITING_FOR_BOARDING;
+            saveState (nFic, &fSt);
+            step[PILOT] = PT_FLY;
+            if (!desDown (&readyToFlight, PILOT)) {
+                return;
+            }
+            break;
+        case PT_FLY:                                                                              /* flight (true) */
+            fSt.st.pilotStat = FLYING;
+            saveState (nFic, &fSt);
+            step[PILOT] = PT_DROP;
+            desSchedule (PILOT, flightTime ());
+            return;
+        case PT_DROP:                                                                       /* dropPassengersAtTarget */
+            saveFlightArrived (nFic, &fSt);
+            fSt.st.pilotStat = DROPING_PASSENGERS;
+            saveState (nFic, &fSt);
+            desUp (&passengersWaitInFlight, fSt.nPassInFlight);
+            step[PILOT] = PT_RETURN;
+            if (!desDown (&planeEmpty, PILOT)) {
+                return;
+            }
+            break;
+        case PT_RETURN:
+            fSt.st.pilotStat = FLYING_BACK;
+            saveFlightReturning (nFic, &fSt);
+            step[PILOT] = PT_FLY_BACK;
+            break;
+        }
+    }
+}
+
+/**
+ *  \brief Running the hostess until she blocks or is over.
+ */
+
+static void hostessRun (void)
+{
+    for (;;) {
+        switch (step[HOSTESS]) {
+        case HT_FLIGHT:                                                                          /* waitForNextFlight */
+            if (nChecked >= N) {
+                step[HOSTESS] = OVER;
+                nOver += 1;
+                return;
+            }
+            fSt.st.hostessStat = WAIT_FOR_FLIGHT;
+            saveState (nFic, &fSt);
+            step[HOSTESS] = HT_PASSENGER;
+            if (!desDown (&readyForBoarding, HOSTESS)) {
+                return;
+            }
+            break;
+        case HT_PASSENGER:                                                                        /* waitForPassenger */
+            fSt.st.hostessStat = WAIT_FOR_PASSENGER;
+            saveState (nFic, &fSt);
+            step[HOSTESS] = HT_CALL;
+            if (!desDown (&passengersInQueue, HOSTESS)) {
+                return;
+            }
+            break;
+        case HT_CALL:                                                                        /* checkPassport, first part */
+            desUp (&passengersWaitInQueue, 1);
+            fSt.st.hostessStat = CHECK_PASSPORT;
+            saveState (nFic, &fSt);
+            step[HOSTESS] = HT_CHECK;
+            if (!desDown (&idShown, HOSTESS)) {
+                return;
+            }
+            break;
+        case HT_CHECK:                                                /* checkPassport, second part, and signalReadyToFlight */
+            fSt.nPassInQueue -= 1;
+            fSt.nPassInFlight += 1;
+            fSt.totalPassBoarded += 1;
+            savePassengerChecked (nFic, &fSt);
+            nChecked += 1;
+            if ((fSt.nPassInFlight == MAXFC) || ((fSt.nPassInFlight >= MINFC) && (fSt.nPassInQueue == 0)) ||
+                (fSt.totalPassBoarded == N)) {
+                fSt.nPassengersInFlight[fSt.nFlight-1] = fSt.nPassInFlight;
+                saveState (nFic, &fSt);
+                fSt.st.hostessStat = READY_TO_FLIGHT;
+                saveState (nFic, &fSt);
+                saveFlightDeparted (nFic, &fSt);
+                if (fSt.totalPassBoarded == N) {
+                    fSt.finished = true;
+                }
+                desUp (&readyToFlight, 1);
+                step[HOSTESS] = HT_FLIGHT;
+            }
+            else {
+                saveState (nFic, &fSt);
+                step[HOSTESS] = HT_PASSENGER;
+            }
+            break;
+        }
+    }
+}
+
+/**
+ *  \brief Running a passenger until it blocks or is over.
+ *
+ *  \param passengerId passenger id
+ */
+
+static void passengerRun (unsigned int passengerId)
+{
+    for (;;) {
+        switch (step[passengerId]) {
+        case PG_QUEUE:                                                                    /* waitInQueue, first part */
+            fSt.st.passengerStat[passengerId] = IN_QUEUE;
+            fSt.nPassInQueue += 1;
+            saveState (nFic, &fSt);
+            desUp (&passengersInQueue, 1);
+            step[passengerId] = PG_SHOW;
+            if (!desDown (&passengersWaitInQueue, passengerId)) {
+                return;
+            }
+            break;
+        case PG_SHOW:                                                                    /* waitInQueue, second part */
+            fSt.passengerChecked = (int) passengerId;
+            fSt.st.passengerStat[passengerId] = IN_FLIGHT;
+            saveState (nFic, &fSt);
+            desUp (&idShown, 1);
+            step[passengerId] = PG_LEAVE;
+            if (!desDown (&passengersWaitInFlight, passengerId)) {
+                return;
+            }
+            break;
+        case PG_LEAVE:                                                                        /* waitUntilDestination */
+            fSt.st.passengerStat[passengerId] = AT_DESTINATION;
+            fSt.nPassInFlight -= 1;
+            saveState (nFic, &fSt);
+            if (fSt.nPassInFlight == 0) {
+                desUp (&planeEmpty, 1);
+            }
+            step[passengerId] = OVER;
+            nOver += 1;
+            return;
+        }
+    }
+}
+
+/**
+ *  \brief Main program.
+ *
+ *  Its role is setting up the full state and the virtual semaphores, scheduling the intervening entities and running
+ *  them until every life cycle is over.
+ */
+
+int main (int argc, char *argv[])
+{
+    unsigned int format = LOG_FULL;                                                                  /* logging format */
+    unsigned int level = LOG_LEVEL_FULL;                                                              /* logging level */
+    unsigned int seed = (unsigned int) getpid ();                                           /* seed of random generator */
+    unsigned int ent;                                                                                /* running entity */
+    unsigned int p;
+    char *tinp;
+    int opt;
+
+    /* getting the options and the log file name */
+    while ((opt = getopt (argc, argv, "dl:r:")) != -1) {
+        switch (opt) {
+        case 'd':
+            format = LOG_DELTA;
+            break;
+        case 'l':
+            if (strcmp (optarg, "full") == 0) {
+                level = LOG_LEVEL_FULL;
+            }
+            else if (strcmp (optarg, "events") == 0) {
+                level = LOG_LEVEL_EVENTS;
+            }
+            else if (strcmp (optarg, "summary") == 0) {
+                level = LOG_LEVEL_SUMMARY;
+            }
+            else {
+                fprintf (stderr, "Invalid logging level (full, events or summary)!\n");
+                exit (EXIT_FAILURE);
+            }
+            break;
+        case 'r':
+            seed = (unsigned int) strtoul (optarg, &tinp, 0);
+            if (*tinp != '\0') {
+                fprintf (stderr, "Invalid seed!\n");
+                exit (EXIT_FAILURE);
+            }
+            break;
+        default:
+            fprintf (stderr, "Usage: %s [-d] [-l full|events|summary] [-r seed] [log file]\n", argv[0]);
+            exit (EXIT_FAILURE);
+        }
+    }
+    if (optind < argc) {
+        if (strlen (argv[optind]) >= sizeof (nFic)) {
+            fprintf (stderr, "The log file name is too long!\n");
+            exit (EXIT_FAILURE);
+        }
+        strcpy (nFic, argv[optind]);
+    }
+    else strcpy (nFic, "");
+    setLogLevel (level);
+    setLogClock (virtualNs);
+
+    srandom (seed);                                                                   /* initialize random generator */
+
+    /* initialize problem internal status */
+
+    fSt.st.pilotStat   = FLYING_BACK;                                     /* the pilot is flying towards starting airport */
+    fSt.st.hostessStat = WAIT_FOR_FLIGHT;                              /* the hostess is waiting for the flight to arrive */
+    for (p = 0; p < N; p++) {
+        fSt.st.passengerStat[p] = GOING_TO_AIRPORT;                            /* the passengers are going to the airport */
+    }
+    fSt.finished         = false;
+    fSt.nPassInQueue     = 0;
+    fSt.nPassInFlight    = 0;
+    fSt.totalPassBoarded = 0;
+    logData.nRec         = 0;                                                                /* the event ring is empty */
+    logData.format       = format;
+
+    createLog (nFic);                                                                             /* log file creation */
+    openLogSession (nFic, &logData);
+
+    /* initialize the virtual semaphores and the engine */
+
+    desSemInit (&passengersInQueue, 0);
+    desSemInit (&passengersWaitInQueue, 0);
+    desSemInit (&passengersWaitInFlight, 0);
+    desSemInit (&readyForBoarding, 0);
+    desSemInit (&readyToFlight, 0);
+    desSemInit (&idShown, 0);
+    desSemInit (&planeEmpty, 0);
+    if (desInit (N+2) == -1) {
+        perror ("error on starting the simulation engine");
+        exit (EXIT_FAILURE);
+    }
+
+    /* scheduling the intervening entities: the passengers arrive at the airport after their travel */
+
+    for (p = 0; p < N; p++) {
+        step[p] = PG_QUEUE;
+        desSchedule (p, travelTime ());
+    }
+    step[HOSTESS] = HT_FLIGHT;
+    desSchedule (HOSTESS, 0);
+    step[PILOT] = PT_FLY_BACK;
+    desSchedule (PILOT, 0);
+
+    /* running the entities in time order */
+
+    while (desNext (&ent)) {
+        if (ent == PILOT) {
+            pilotRun ();
+        }
+        else if (ent == HOSTESS) {
+            hostessRun ();
+        }
+        else passengerRun (ent);
+    }
+    if (nOver < N+2) {                                             /* no entity scheduled, but some still blocked */
+        fprintf (stderr, "The simulation stalled: %u entities blocked at time %llu us!\n", N+2 - nOver, desNow ());
+        closeLogSession ();
+        desEnd ();
+        exit (EXIT_FAILURE);
+    }
+
+    saveAirLiftResult (nFic, &fSt);
+    closeLogSession ();
+    desEnd ();
+
+    return EXIT_SUCCESS;
+}
@@ -8,8 +8,41 @@
  *
  *  Generator process of the intervening entities.
  *
- *  Upon execution, one parameter is requested:
- *    \li name of the logging file.
+ *  Upon execution, the following parameters are accepted:
+ *    \li <tt>-d</tt>: log the lines of state in the delta format ("." for the entities whose state did not change)
+ *    \li <tt>-l level</tt>: logging level, <tt>full</tt> (default), <tt>events</tt> (no lines of state) or
+ *        <tt>summary</tt> (only the summary of the air lift)
+ *    \li <tt>-w interval</tt>: watchdog interval, in ms (<tt>WATCHDOG</tt>, by default; 0 disables the watchdog)
+ *    \li <tt>-k key</tt>: access key to the shared region and the semaphore set (by default, the first of
+ *        <tt>ftok (".", 'a')</tt>, <tt>ftok (".", 'b')</tt>, ... that is free, up to <tt>NKEYS</tt> of them)
+ *    \li <tt>-s limit</tt>: spin limit of the access semaphore to the critical region (see <tt>semSetSpin</tt>;
+ *        <tt>SPINLIMIT</tt> on a multiprocessor and 0 on a single processor, by default); when given, the spin
+ *        counters are written to stderr at the end
+ *    \li name of the logging file (stdout, if absent).
+ *
+ *  While waiting for the entities, the main process acts as a watchdog, reading the full state of the problem under
+ *  its sequence counter, without entering the critical region: if the full state does not change for the watchdog
+ *  interval, or an entity terminates abnormally, the simulation is taken as stalled. The full state and the
+ *  semaphore values are then written to stderr, the entities are killed, the semaphore set and the shared region are
+ *  destroyed and the process terminates with <tt>EXIT_FAILURE</tt>, so that a batch of runs can go on.
+ *
+ *  The key is taken from the registry of the working directory (see <tt>ipcRegistry.h</tt>), which first reclaims
+ *  the semaphore sets and shared regions left behind by the generators that are no longer alive, and is given back
+ *  at the end. Runs started at the same time get different keys, so they do not interfere; unless the key is
+ *  <tt>ftok (".", 'a')</tt>, the names of the error files start with <tt>error_</tt><em>key in hexadecimal</em>
+ *  <tt>_</tt>.
+ *
+ *  When built with <tt>SEM_STATS</tt> (see <tt>semStats.h</tt>), the statistics of the semaphore operations are
+ *  printed to stdout at the end.
+ *
+ *  When built with <tt>THREADED</tt> (see <tt>entityThreads.h</tt>), the entities are threads of this process
+ *  instead, and the shared region is ordinary memory (except with the POSIX semaphores, which live in it). Upon a
+ *  stall, the process terminates with the entities still running.
+ *
+ *  When also built with <tt>SEM_CORO</tt>, the entities are coroutines run by a single scheduler thread, on one
+ *  shared stack, and the coroutine figures (number of switches, memory per entity, run time) are written to stderr
+ *  at the end; a large number of passengers is set with e.g. <tt>-DN=100000 -DMAXNF=20000</tt>. The simulation is
+ *  also taken as stalled when every coroutine left is blocked.
  *
  *  \author Nuno Lau - January 2022
  */
@@ -18,11 +51,22 @@
 #include <stdlib.h>
 #include <stdbool.h>
 #include <unistd.h>
+#include <signal.h>
+#include <time.h>
 #include <sys/wait.h>
 #include <sys/types.h>
 #include <sys/ipc.h>
 #include <string.h>
 #include <math.h>
+#ifdef THREADED
+#include <stdint.h>
+#include <errno.h>
+#include <pthread.h>
+#endif
+#ifdef SEM_CORO
+#include <sys/time.h>
+#include <sys/resource.h>
+#endif
 
 #include "probConst.h"
 #include "probDataStruct.h"
@@ -30,6 +74,13 @@
 #include "sharedDataSync.h"
 #include "semaphore.h"
 #include "sharedMemory.h"
+#include "seqLock.h"
+#include "entityThreads.h"
+#include "ipcRegistry.h"
+
+#if (N + MINFC - 1) / MINFC > MAXNF
+#error "MAXNF is too small for N passengers"
+#endif
 
 /** \brief name of pilot process */
 #define   PILOT         "./pilot"
@@ -40,6 +91,269 @@
 /** \brief name of passenger process */
 #define   PASSENGER     "./passenger"
 
+/** \brief name of logger process (asynchronous logging build) */
+#define   LOGGER        "./logger"
+
+/** \brief default spin limit of the access semaphore to the critical region, on a multiprocessor */
+#define   SPINLIMIT     100
+
+/** \brief default time without changes of the full state after which the simulation is stalled (in ms) */
+#define   WATCHDOG      1000
+
+/** \brief period of the checks of the watchdog (in ms) */
+#define   WATCHPERIOD   5
+
+/** \brief largest number of copies of the full state taken by the watchdog at every check */
+#define   SNAPTRIES     100
+
+/** \brief number of candidate keys taken from the registry (one project id of <tt>ftok</tt> each) */
+#define   NKEYS         64
+
+/** \brief size of the stack shared by the coroutines (coroutine build) */
+#define   CORO_STACK    (256 * 1024 + 4 * sizeof (LOG_REC))
+
+/**
+ *  \brief Getting the present time in ms.
+ */
+
+static long long nowMs (void)
+{
+    struct timespec t;
+
+    clock_gettime (CLOCK_MONOTONIC, &t);
+    return (long long) t.tv_sec * 1000 + t.tv_nsec / 1000000;
+}
+
+/**
+ *  \brief Taking a copy of the full state of the problem without entering the critical region.
+ *
+ *  \param sh pointer to shared memory region
+ *  \param fSt pointer to the copy
+ *
+ *  \return true, if the copy was taken, false, if an update was going on all the time
+ */
+
+static bool takeSnapshot (SHARED_DATA *sh, FULL_STAT *fSt)
+{
+    return seqRead (&sh->fStSeq, &sh->fSt, fSt, sizeof (FULL_STAT), SNAPTRIES) == 0;
+}
+
+#ifdef THREADED
+
+/** \brief number of intervening entities whose life cycle is over (threaded build) */
+static unsigned int nDone = 0;
+
+/**
+ *  \brief Thread of the pilot (threaded build).
+ */
+
+static void *pilotThread (void *arg)
+{
+    pilotLife ();
+    __atomic_add_fetch (&nDone, 1, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+/**
+ *  \brief Thread of the hostess (threaded build).
+ */
+
+static void *hostessThread (void *arg)
+{
+    hostessLife ();
+    __atomic_add_fetch (&nDone, 1, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+/**
+ *  \brief Thread of a passenger (threaded build).
+ *
+ *  \param arg passenger id
+ */
+
+static void *passengerThread (void *arg)
+{
+    passengerLife ((unsigned int) (uintptr_t) arg);
+    __atomic_add_fetch (&nDone, 1, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+#ifdef SEM_CORO
+
+/** \brief number of coroutines left blocked by the scheduler (coroutine build) */
+static unsigned long nBlocked = 0;
+
+/** \brief the scheduler is over (coroutine build) */
+static bool schedOver = false;
+
+/**
+ *  \brief Thread of the scheduler, which runs the coroutines of the intervening entities (coroutine build).
+ */
+
+static void *schedulerThread (void *arg)
+{
+    nBlocked = coRun ();
+    __atomic_store_n (&schedOver, true, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+/**
+ *  \brief Writing the coroutine figures.
+ *
+ *  \param fp stream they are written to
+ *  \param start time the coroutines were created at (in ms)
+ */
+
+static void coroReport (FILE *fp, long long start)
+{
+    CO_STATS st;
+    struct rusage ru;
+    double wall = (double) (nowMs () - start) / 1000.0,                                       /* run time (in s) */
+           cpu;                                                                     /* processor time (in s) */
+
+    coStats (&st);
+    getrusage (RUSAGE_SELF, &ru);
+    cpu = (double) (ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) + (double) (ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) / 1e6;
+    fprintf (fp, "Coroutines: %lu, %lu switches, %zu bytes each plus a saved stack of up to %zu bytes "
+             "(%zu bytes at most in all)\n", st.nCreated, st.nSwitches, st.taskSize, st.maxSaved, st.peakSaved);
+    fprintf (fp, "Passengers: %d in %.3f s (%.0f per s), %.3f s of processor (%.0f per s), maximum resident set %ld kB\n",
+             N, wall, N / wall, cpu, (cpu > 0.0) ? N / cpu : 0.0, ru.ru_maxrss);
+}
+
+#endif
+
+#ifdef LOG_ASYNC
+
+/**
+ *  \brief Definition of <em>arguments of the logger thread</em> data type (threaded build).
+ */
+typedef struct
+        { /** \brief name of the logging file */
+          char *nFic;
+          /** \brief pointer to the logging data shared by all the intervening entities */
+          LOG_SHARED *p_log;
+
+        } LOGGER_ARG;
+
+/**
+ *  \brief Thread of the logger, the only writer of the logging file (threaded build).
+ *
+ *  \param arg pointer to the arguments
+ */
+
+static void *loggerThread (void *arg)
+{
+    serveLog (((LOGGER_ARG *) arg)->nFic, ((LOGGER_ARG *) arg)->p_log);
+    return NULL;
+}
+
+#endif
+
+#endif
+
+/**
+ *  \brief Creating the shared region and mapping it onto the process address space.
+ *
+ *  In the threaded build, the region is ordinary memory, unless the POSIX semaphores are used: they are kept at the
+ *  start of the shared memory block with the key of the set.
+ *  The contents are all 0 bytes.
+ *
+ *  \param key creation key
+ *  \param pShmid pointer to the location where the shared memory block identifier is stored (-1, if none)
+ *
+ *  \return pointer to the region
+ */
+
+static SHARED_DATA *createRegion (int key, int *pShmid)
+{
+    SHARED_DATA *sh;
+
+#if defined (THREADED) && !defined (SEM_POSIX)
+    if ((errno = posix_memalign ((void **) &sh, CACHELINE, sizeof (SHARED_DATA))) != 0) {
+        perror ("error on allocating the shared region");
+        exit (EXIT_FAILURE);
+    }
+    memset (sh, 0, sizeof (SHARED_DATA));
+    *pShmid = -1;
+#else
+    if ((*pShmid = shmemCreate (key, sizeof (SHARED_DATA))) == -1) { 
+        perror ("error on creating the shared memory region");
+        exit (EXIT_FAILURE);
+    }
+    if (shmemAttach (*pShmid, (void **) &sh) == -1) { 
+        perror ("error on mapping the shared region on the process address space");
+        exit (EXIT_FAILURE);
+    }
+#endif
+    return sh;
+}
+
+/**
+ *  \brief Destruction of the shared region.
+ *
+ *  \param sh pointer to the region
+ *  \param shmid shared memory block identifier (-1, if none)
+ */
+
+static void destroyRegion (SHARED_DATA *sh, int shmid)
+{
+    if (shmid == -1) {
+        free (sh);
+        return;
+    }
+    if (shmemDettach (sh) == -1) { 
+        perror ("error on unmapping the shared region off the process address space");
+        exit (EXIT_FAILURE);
+    }
+    if (shmemDestroy (shmid) == -1) { 
+        perror ("error on destructing the shared region");
+        exit (EXIT_FAILURE);
+    }
+}
+
+#ifndef THREADED
+
+/**
+ *  \brief Killing an intervening process, unless it has already terminated.
+ *
+ *  \param pid process identifier (0, if it has already terminated)
+ */
+
+static void killEntity (int pid)
+{
+    if (pid > 0) {
+        kill (pid, SIGKILL);
+    }
+}
+
+#endif
+
+/**
+ *  \brief Writing the full state of the problem and the semaphore values of a stalled simulation.
+ *
+ *  \param fp stream they are written to
+ *  \param fSt pointer to the last copy of the full state
+ *  \param semgid semaphore set access identifier
+ */
+
+static void dumpStall (FILE *fp, const FULL_STAT *fSt, int semgid)
+{
+    static const char *const semName[SEM_NU+1] = SEM_NAMES;
+    unsigned int s;
+    int p;
+
+    fprintf (fp, "Pilot %u, hostess %u, passengers", fSt->st.pilotStat, fSt->st.hostessStat);
+    for (p = 0; p < N; p++) {
+        fprintf (fp, " %u", fSt->st.passengerStat[p]);
+    }
+    fprintf (fp, "\nFlight %u, in queue %u, in flight %u, boarded %u, finished %d, last checked %d\n",
+             fSt->nFlight, fSt->nPassInQueue, fSt->nPassInFlight, fSt->totalPassBoarded, fSt->finished,
+             fSt->passengerChecked);
+    for (s = 1; s <= SEM_NU; s++) {
+        fprintf (fp, "%-24s %d\n", semName[s], semGetValue (semgid, s));
+    }
+}
+
 /**
  *  \brief Main program.
  *
@@ -50,44 +364,148 @@
 int main (int argc, char *argv[])
 {
     char nFic[51];                                                                              /*name of logging file */
-    char nFicErr[] = "error_        ";                                                     /* base name of error files */
+#ifndef THREADED
+    char nFicErr[32] = "error_";                                                          /* base name of error files */
+    int errLen = 6;                                                     /* length of the prefix of the error files */
+#endif
     int shmid,                                                                      /* shared memory access identifier */
         semgid;                                                                     /* semaphore set access identifier */
-    unsigned int  m;                                                                             /* counting variables */
     SHARED_DATA *sh;                                                                /* pointer to shared memory region */
+#if defined (THREADED) && defined (SEM_CORO)
+    pthread_t tidCO;                                                                   /* scheduler thread identifier */
+    long long start;                                                 /* time the coroutines were created at (in ms) */
+#elif defined (THREADED)
+    pthread_t tidPT,                                                                        /* pilot thread identifier */
+              tidHT,                                                                      /* hostess thread identifier */
+              tidPG[N];                                                             /* passengers threads identifier array */
+#else
     int pidPT,                                                                             /* pilot process identifier */
         pidHT,                                                                     /* hostess process identifier array */
         pidPG[N];                                                             /* passengers processes identifier array */
-    int key;                                                           /*access key to shared memory and semaphore set */
-    char num[2][12];                                                     /* numeric value conversion (up to 10 digits) */
+    unsigned int  m;                                                                             /* counting variables */
     int status,                                                                                    /* execution status */
         info;                                                                                               /* info id */
+    char *lvl;                                            /* logging level argument of the entities (NULL, if full) */
+#endif
+#ifdef LOG_ASYNC
+#ifdef THREADED
+    pthread_t tidLG;                                                                       /* logger thread identifier */
+    LOGGER_ARG lgArg;                                                                  /* arguments of the logger thread */
+#else
+    int pidLG;                                                                            /* logger process identifier */
+#endif
+#endif
+    int key;                                                           /*access key to shared memory and semaphore set */
+    bool keyGiven = false;                                                           /* the key was given (-k) */
+    int keys[NKEYS];                                                                             /* candidate keys */
+    unsigned int nKeys = NKEYS;                                                         /* number of candidate keys */
+    int nReclaimed;                                       /* number of terminated runs whose resources were reclaimed */
+    char num[3][12];                                                     /* numeric value conversion (up to 10 digits) */
     int p;
-
-    /* getting log file name */
-    if(argc==2) {
-        strcpy(nFic, argv[1]);
+    unsigned int format = LOG_FULL;                                                                  /* logging format */
+    unsigned int level = LOG_LEVEL_FULL;                                                              /* logging level */
+    long spin = (sysconf (_SC_NPROCESSORS_ONLN) > 1) ? SPINLIMIT : 0;                     /* spin limit of the mutex */
+    bool spinStats = false;                                                          /* report the spin counters */
+    SEM_SPIN_STATS stats;
+    long watchdog = WATCHDOG;                                                          /* watchdog interval (in ms) */
+    FULL_STAT last, cur;                                                    /* last and present copies of the full state */
+    long long lastChange;                                                     /* time of the last change (in ms) */
+    const char *stall = NULL;                                                /* cause of the stall (NULL, if none) */
+    char *tinp;
+    int opt;
+
+    /* getting the options and the log file name */
+    while ((opt = getopt (argc, argv, "dk:l:s:w:")) != -1) {
+        switch (opt) {
+        case 'd':
+            format = LOG_DELTA;
+            break;
+        case 'l':
+            if (strcmp (optarg, "full") == 0) {
+                level = LOG_LEVEL_FULL;
+            }
+            else if (strcmp (optarg, "events") == 0) {
+                level = LOG_LEVEL_EVENTS;
+            }
+            else if (strcmp (optarg, "summary") == 0) {
+                level = LOG_LEVEL_SUMMARY;
+            }
+            else {
+                fprintf (stderr, "Invalid logging level (full, events or summary)!\n");
+                exit (EXIT_FAILURE);
+            }
+            break;
+        case 's':
+            spin = strtol (optarg, &tinp, 0);
+            if ((*tinp != '\0') || (spin < 0)) {
+                fprintf (stderr, "Invalid spin limit!\n");
+                exit (EXIT_FAILURE);
+            }
+            spinStats = true;
+            break;
+        case 'k':
+            key = (int) strtol (optarg, &tinp, 0);
+            if ((*tinp != '\0') || (key == IPC_PRIVATE) || (key == -1)) {
+                fprintf (stderr, "Invalid access key!\n");
+                exit (EXIT_FAILURE);
+            }
+            keyGiven = true;
+            break;
+        case 'w':
+            watchdog = strtol (optarg, &tinp, 0);
+            if ((*tinp != '\0') || (watchdog < 0)) {
+                fprintf (stderr, "Invalid watchdog interval!\n");
+                exit (EXIT_FAILURE);
+            }
+            break;
+        default:
+            fprintf (stderr, "Usage: %s [-d] [-k key] [-l full|events|summary] [-s spin limit] [-w interval] [log file]\n", argv[0]);
+            exit (EXIT_FAILURE);
+        }
+    }
+    if (optind < argc) {
+        if (strlen (argv[optind]) >= sizeof (nFic)) {
+            fprintf (stderr, "The log file name is too long!\n");
+            exit (EXIT_FAILURE);
+        }
+        strcpy(nFic, argv[optind]);
     }
     else strcpy(nFic, "");
 
     /* composing command line */
 
-    if ((key = ftok (".", 'a')) == -1) {
-        perror ("error on generating the key");
+    for (p = 0; p < NKEYS; p++) {
+        if ((keys[p] = ftok (".", 'a' + p)) == -1) {
+            perror ("error on generating the key");
+            exit (EXIT_FAILURE);
+        }
+    }
+    if (keyGiven) {
+        keys[0] = key;
+        nKeys = 1;
+    }
+    if ((nReclaimed = ipcRegAcquire (IPCREGFILE, keys, nKeys, &key)) == -1) {
+        perror ("error on getting a free access key");
         exit (EXIT_FAILURE);
     }
+    if (nReclaimed > 0) {
+        fprintf (stderr, "Reclaimed the resources left by %d terminated run(s)\n", nReclaimed);
+    }
     sprintf (num[1], "%d", key);
+#ifndef THREADED
+    if (key != ftok (".", 'a')) {
+        errLen = sprintf (nFicErr, "error_%x_", (unsigned int) key);
+    }
+#endif
+    sprintf (num[2], "%u", level);
+#ifndef THREADED
+    lvl = (level == LOG_LEVEL_FULL) ? NULL : num[2];          /* not passed by default: the _bin entities reject it */
+#endif
+    setLogLevel (level);
 
     /* creating and initializing the shared memory region and the log file */
 
-    if ((shmid = shmemCreate (key, sizeof (SHARED_DATA))) == -1) { 
-        perror ("error on creating the shared memory region");
-        exit (EXIT_FAILURE);
-    }
-    if (shmemAttach (shmid, (void **) &sh) == -1) { 
-        perror ("error on mapping the shared region on the process address space");
-        exit (EXIT_FAILURE);
-    }
+    sh = createRegion (key, &shmid);
 
     srandom ((unsigned int) getpid ());                                                      /* initialize random generator */
 
@@ -103,10 +521,13 @@ int main (int argc, char *argv[])
     sh->fSt.nPassInQueue     = 0;                                          
     sh->fSt.nPassInFlight    = 0;                                         
     sh->fSt.totalPassBoarded = 0;                                        
+    sh->log.nRec             = 0;                                                          /* the event ring is empty */
+    sh->log.format           = format;
 
     /* initialize problem internal status */
 
     createLog (nFic);                                                                             /* log file creation */
+    openLogSession (nFic, &sh->log);
 
     /* initialize semaphore ids */
 
@@ -129,46 +550,126 @@ int main (int argc, char *argv[])
         perror ("error on executing the up operation for semaphore access");
         exit (EXIT_FAILURE);
     }
+    if (semSetSpin (semgid, sh->mutex, (unsigned int) spin) == -1) {   /* short critical regions: spin, then block */
+        perror ("error on setting the spin limit of semaphore access");
+        exit (EXIT_FAILURE);
+    }
 
+#if defined (LOG_ASYNC) && defined (THREADED)
+    /* generation of the logger thread, the only writer of the logging file */
+
+    lgArg.nFic = nFic;
+    lgArg.p_log = &sh->log;
+    if ((errno = pthread_create (&tidLG, NULL, loggerThread, &lgArg)) != 0) {
+        perror ("error on the creation of the logger thread");
+        exit (EXIT_FAILURE);
+    }
+#elif defined (LOG_ASYNC)
+    /* generation of the logger process, the only writer of the logging file */
+
+    strcpy (nFicErr + errLen, "LG");
+    if ((pidLG = fork ()) < 0) {
+        perror ("error on the fork operation for the logger");
+        exit (EXIT_FAILURE);
+    }
+    if (pidLG == 0)
+        if (execl (LOGGER, LOGGER, nFic, num[1], nFicErr, NULL) < 0) { 
+            perror ("error on the generation of the logger process");
+            exit (EXIT_FAILURE);
+        }
+#endif
+
+#if defined (THREADED) && defined (SEM_CORO)
+    /* generation of intervening entities coroutines, bound to the region and the semaphore set, and of the thread
+       of their scheduler */
+
+    pilotBind (nFic, semgid, sh);
+    hostessBind (nFic, semgid, sh);
+    passengerBind (nFic, semgid, sh);
+    start = nowMs ();
+    if (coInit (CORO_STACK) == -1) {
+        perror ("error on the creation of the coroutine stack");
+        exit (EXIT_FAILURE);
+    }
+    for (p = 0; p < N; p++) {                                                                 /* passenger coroutines */
+        if (coSpawn (passengerThread, (void *) (uintptr_t) p) == -1) {
+            perror ("error on the creation of the passenger coroutine");
+            exit (EXIT_FAILURE);
+        }
+    }
+    if (coSpawn (hostessThread, NULL) == -1) {                                                    /* hostess coroutine */
+        perror ("error on the creation of the hostess coroutine");
+        exit (EXIT_FAILURE);
+    }
+    if (coSpawn (pilotThread, NULL) == -1) {                                                        /* pilot coroutine */
+        perror ("error on the creation of the pilot coroutine");
+        exit (EXIT_FAILURE);
+    }
+    if ((errno = pthread_create (&tidCO, NULL, schedulerThread, NULL)) != 0) {
+        perror ("error on the creation of the scheduler thread");
+        exit (EXIT_FAILURE);
+    }
+#elif defined (THREADED)
+    /* generation of intervening entities threads, bound to the region and the semaphore set */
+
+    pilotBind (nFic, semgid, sh);
+    hostessBind (nFic, semgid, sh);
+    passengerBind (nFic, semgid, sh);
+    for (p = 0; p < N; p++) {                                                                    /* passenger threads */
+        if ((errno = pthread_create (&tidPG[p], NULL, passengerThread, (void *) (uintptr_t) p)) != 0) {
+            perror ("error on the creation of the passenger thread");
+            exit (EXIT_FAILURE);
+        }
+    }
+    if ((errno = pthread_create (&tidHT, NULL, hostessThread, NULL)) != 0) {                         /* hostess thread */
+        perror ("error on the creation of the hostess thread");
+        exit (EXIT_FAILURE);
+    }
+    if ((errno = pthread_create (&tidPT, NULL, pilotThread, NULL)) != 0) {                             /* pilot thread */
+        perror ("error on the creation of the pilot thread");
+        exit (EXIT_FAILURE);
+    }
+#else
     /* generation of intervening entities processes */
 
-    strcpy (nFicErr + 6, "PG");
+    strcpy (nFicErr + errLen, "PG");
     for (p = 0; p < N; p++) {                                                                  /* passenger processes */
         if ((pidPG[p] = fork ()) < 0) {
             perror ("error on the fork operation for the passenger");
             exit (EXIT_FAILURE);
         }
         sprintf(num[0],"%d",p);
-        sprintf(nFicErr+8,"%02d",p); 
+        sprintf(nFicErr+errLen+2,"%02d",p); 
         if (pidPG[p] == 0)
-            if (execl (PASSENGER, PASSENGER, num[0], nFic, num[1],nFicErr, NULL) < 0) { 
+            if (execl (PASSENGER, PASSENGER, num[0], nFic, num[1],nFicErr, lvl, NULL) < 0) { 
                 perror ("error on the generation of the passenger process");
                 exit (EXIT_FAILURE);
             }
     }
 
-    strcpy (nFicErr + 6, "HT");
+    strcpy (nFicErr + errLen, "HT");
     if ((pidHT = fork ()) < 0)  {                                                               /* hostess process */
         perror ("error on the fork operation for the hostess");
         exit (EXIT_FAILURE);
     }
     if (pidHT == 0) {
-        if (execl (HOSTESS, HOSTESS, nFic, num[1], nFicErr, NULL) < 0) {
+        if (execl (HOSTESS, HOSTESS, nFic, num[1], nFicErr, lvl, NULL) < 0) {
             perror ("error on the generation of the hostess process");
             exit (EXIT_FAILURE);
         }
     }
 
-    strcpy (nFicErr + 6, "PT");
+    strcpy (nFicErr + errLen, "PT");
     if ((pidPT = fork ()) < 0) {                                                                   /* pilot process */
         perror ("error on the fork operation for the pilot");
         exit (EXIT_FAILURE);
     }
     if (pidPT == 0)
-        if (execl (PILOT, PILOT, nFic, num[1], nFicErr, NULL) < 0) { 
+        if (execl (PILOT, PILOT, nFic, num[1], nFicErr, lvl, NULL) < 0) { 
             perror ("error on the generation of the referee process");
             exit (EXIT_FAILURE);
         }
+#endif
 
     /* signaling start of operations */
 
@@ -177,19 +678,142 @@ int main (int argc, char *argv[])
         exit (EXIT_FAILURE);
     }
 
-    /* waiting for the termination of the intervening entities processes */
+#ifdef THREADED
+    /* waiting for the termination of the intervening entities threads, watching for a stall (an entity that fails
+       terminates the whole process) */
+
+    memcpy (&last, &sh->fSt, sizeof (FULL_STAT));
+    lastChange = nowMs ();
+    while ((watchdog > 0) && (__atomic_load_n (&nDone, __ATOMIC_ACQUIRE) < N+2) && (stall == NULL)
+#ifdef SEM_CORO
+           && !__atomic_load_n (&schedOver, __ATOMIC_ACQUIRE)
+#endif
+          ) {
+        usleep (WATCHPERIOD * 1000);
+        if (takeSnapshot (sh, &cur) && (memcmp (&cur, &last, sizeof (FULL_STAT)) != 0)) {
+            memcpy (&last, &cur, sizeof (FULL_STAT));
+            lastChange = nowMs ();
+        }
+        else if (nowMs () - lastChange >= watchdog) {
+            stall = "no change of the full state within the watchdog interval";
+        }
+    }
+#ifdef SEM_CORO
+    if (stall == NULL) {
+        pthread_join (tidCO, NULL);
+        if (nBlocked > 0) {
+            memcpy (&last, &sh->fSt, sizeof (FULL_STAT));                   /* no coroutine runs any longer */
+            stall = "every coroutine left is blocked";
+        }
+    }
+#else
+    if (stall == NULL) {
+        for (p = 0; p < N; p++) {
+            pthread_join (tidPG[p], NULL);
+        }
+        pthread_join (tidHT, NULL);
+        pthread_join (tidPT, NULL);
+    }
+#endif
+#else
+    /* waiting for the termination of the intervening entities processes, watching for a stall */
 
     m = 0;
+    memcpy (&last, &sh->fSt, sizeof (FULL_STAT));
+    lastChange = nowMs ();
     do {
-        info = wait (&status);
+        info = waitpid (-1, &status, (watchdog > 0) ? WNOHANG : 0);
         if (info == -1)
         { perror ("error on waiting for an intervening process");
             exit (EXIT_FAILURE);
         }
-        m += 1;
-    } while (m < N+2);
+        if (info > 0) {
+            for (p = 0; p < N; p++) {                                          /* not to be killed upon a stall */
+                if (pidPG[p] == info) {
+                    pidPG[p] = 0;
+                    m += 1;
+                }
+            }
+            if (pidHT == info) {
+                pidHT = 0;
+                m += 1;
+            }
+            if (pidPT == info) {
+                pidPT = 0;
+                m += 1;
+            }
+#ifdef LOG_ASYNC
+            if (pidLG == info) {                                      /* not an entity: it is not counted */
+                pidLG = 0;
+            }
+#endif
+            if (!WIFEXITED (status) || (WEXITSTATUS (status) != EXIT_SUCCESS)) {
+                stall = "an intervening process terminated abnormally";
+            }
+            continue;
+        }
+        usleep (WATCHPERIOD * 1000);
+        if (takeSnapshot (sh, &cur) && (memcmp (&cur, &last, sizeof (FULL_STAT)) != 0)) {
+            memcpy (&last, &cur, sizeof (FULL_STAT));
+            lastChange = nowMs ();
+        }
+        else if (nowMs () - lastChange >= watchdog) {
+            stall = "no change of the full state within the watchdog interval";
+        }
+    } while ((m < N+2) && (stall == NULL));
+#endif
+
+    if (stall != NULL) {
+        fprintf (stderr, "The simulation stalled: %s!\n", stall);
+        dumpStall (stderr, &last, semgid);
+#ifndef THREADED
+        for (p = 0; p < N; p++) {                                         /* kill the entities still running */
+            killEntity (pidPG[p]);
+        }
+        killEntity (pidHT);
+        killEntity (pidPT);
+#ifdef LOG_ASYNC
+        killEntity (pidLG);
+#endif
+        while (waitpid (-1, &status, 0) > 0) {
+        }
+#endif
+        closeLogSession ();
+        semDestroy (semgid);
+#ifdef THREADED
+        if (shmid != -1) {                                    /* the mapping is left to the threads still running */
+            shmemDestroy (shmid);
+        }
+#else
+        destroyRegion (sh, shmid);
+#endif
+        ipcRegRelease (IPCREGFILE, key);
+        exit (EXIT_FAILURE);
+    }
 
     saveAirLiftResult(nFic,&sh->fSt);
+    closeLogSession ();
+#if defined (LOG_ASYNC) && defined (THREADED)
+    pthread_join (tidLG, NULL);                                         /* the logger writes the remaining records */
+#elif defined (LOG_ASYNC)
+    if ((pidLG > 0) && (waitpid (pidLG, &status, 0) == -1)) {                            /* the logger writes the remaining records */
+        perror ("error on waiting for the logger process");
+        exit (EXIT_FAILURE);
+    }
+#endif
+#ifdef SEM_CORO
+    coroReport (stderr, start);
+#endif
+    semStatsPrint (stdout, &sh->semStats, ((const char *const []) SEM_NAMES), SEM_NU + 1);     /* built with SEM_STATS */
+
+    if (spinStats) {
+        if (semSpinStats (semgid, sh->mutex, &stats) == -1) {
+            perror ("error on getting the spin counters of semaphore access");
+            exit (EXIT_FAILURE);
+        }
+        fprintf (stderr, "Critical region: %lu entries after spinning, %lu blocks (spin limit %ld)\n",
+                 stats.nSpinAcquired, stats.nBlocked, spin);
+    }
 
     /* destruction of semaphore set and shared region */
 
@@ -197,12 +821,9 @@ int main (int argc, char *argv[])
         perror ("error on destructing the semaphore set");
         exit (EXIT_FAILURE);
     }
-    if (shmemDettach (sh) == -1) { 
-        perror ("error on unmapping the shared region off the process address space");
-        exit (EXIT_FAILURE);
-    }
-    if (shmemDestroy (shmid) == -1) { 
-        perror ("error on destructing the shared region");
+    destroyRegion (sh, shmid);
+    if (ipcRegRelease (IPCREGFILE, key) == -1) {
+        perror ("error on giving the access key back");
         exit (EXIT_FAILURE);
     }
 
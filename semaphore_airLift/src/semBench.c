@@ -0,0 +1,247 @@
+/**
+ *  \file semBench.c (implementation file)
+ *
+ *  \brief Problem name: Air Lift.
+ *
+ *  Benchmark of the semaphore implementations.
+ *
+ *  The same source is built once for every implementation of <tt>semaphore.h</tt> (see the <tt>bench</tt> target
+ *  of the Makefile and <tt>semBench.sh</tt>), so that they can be compared side by side. The following tests are
+ *  carried out through the semaphore operations:
+ *    \li <tt>updown</tt>: one process does an <em>up</em> followed by a <em>down</em> of the same semaphore
+ *        (uncontended operations)
+ *    \li <tt>pingpong</tt>: two processes wake each other up through two semaphores (every operation blocks)
+ *    \li <tt>mutex</tt>: several processes increment a shared counter inside a critical region.
+ *
+ *  Upon execution, the following parameters are accepted:
+ *    \li <tt>-n iterations</tt>: number of operations of every test (100000, by default)
+ *    \li <tt>-p processes</tt>: number of processes of the <tt>mutex</tt> test (4, by default)
+ *    \li <tt>-s limit</tt>: spin limit of the semaphore of the <tt>mutex</tt> test (0, by default; see
+ *        <tt>semSetSpin</tt>), whose spin counters are then written as well.
+ *
+ *  The mean time of an iteration is written to stdout.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/types.h>
+#include <sys/ipc.h>
+#include <sys/wait.h>
+
+#include "semaphore.h"
+#include "sharedMemory.h"
+
+/** \brief name of the semaphore implementation */
+#if defined (SEM_FUTEX)
+#define  BACKEND        "futex"
+#elif defined (SEM_POSIX)
+#define  BACKEND        "posix"
+#else
+#define  BACKEND        "sysv"
+#endif
+
+/** \brief semaphore of the updown test and first semaphore of the pingpong test */
+#define  PING           1
+
+/** \brief second semaphore of the pingpong test */
+#define  PONG           2
+
+/** \brief semaphore of the mutex test */
+#define  LOCK           3
+
+/** \brief number of semaphores in the set */
+#define  NSEM           3
+
+/**
+ *  \brief Definition of <em>benchmark shared data</em> data type.
+ */
+typedef struct
+        {
+#ifdef SEM_POSIX
+          /** \brief semaphores of the POSIX build (they must be at the start of the region) */
+          SEM_SET sem;
+
+#endif
+          /** \brief counter incremented inside the critical region */
+          unsigned long counter;
+
+        } BENCH_DATA;
+
+/** \brief semaphore set identifier */
+static int semgid;
+
+/**
+ *  \brief Getting the present time in ns.
+ */
+
+static double now (void)
+{
+    struct timespec t;
+
+    clock_gettime (CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1e9 + t.tv_nsec;
+}
+
+/**
+ *  \brief Carrying out an operation, aborting the benchmark if it fails.
+ */
+
+static void check (int stat, const char *msg)
+{
+    if (stat == -1) {
+        perror (msg);
+        exit (EXIT_FAILURE);
+    }
+}
+
+/**
+ *  \brief Waiting for the termination of the child processes.
+ *
+ *  \param n number of child processes
+ */
+
+static void waitChildren (int n)
+{
+    int status;
+
+    for (; n > 0; n--) {
+        if ((wait (&status) == -1) || !WIFEXITED (status) || (WEXITSTATUS (status) != EXIT_SUCCESS)) {
+            fprintf (stderr, "A benchmark process failed!\n");
+            exit (EXIT_FAILURE);
+        }
+    }
+}
+
+/**
+ *  \brief Printing the result of a test.
+ *
+ *  \param test name of the test
+ *  \param t0 time at the start of the test (in ns)
+ *  \param n number of iterations
+ */
+
+static void report (const char *test, double t0, long n)
+{
+    printf ("%-6s %-9s %10.1f ns/iteration\n", BACKEND, test, (now () - t0) / (double) n);
+    fflush (stdout);                                                    /* not to be printed again by the children */
+}
+
+/**
+ *  \brief Main program.
+ *
+ *  Its role is creating the semaphore set and the shared region and carrying out the tests.
+ */
+
+int main (int argc, char *argv[])
+{
+    long n = 100000, i;                                                                      /* number of iterations */
+    int nProc = 4, p;                                                            /* number of processes (mutex test) */
+    long spin = 0;                                                                        /* spin limit (mutex test) */
+    SEM_SPIN_STATS stats;
+    int key, shmid;
+    BENCH_DATA *bd;
+    double t0;
+    char *tinp;
+    int opt;
+
+    while ((opt = getopt (argc, argv, "n:p:s:")) != -1) {
+        switch (opt) {
+        case 'n':
+            n = strtol (optarg, &tinp, 0);
+            break;
+        case 'p':
+            nProc = (int) strtol (optarg, &tinp, 0);
+            break;
+        case 's':
+            spin = strtol (optarg, &tinp, 0);
+            break;
+        default:
+            fprintf (stderr, "Usage: %s [-n iterations] [-p processes] [-s spin limit]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+        if ((*tinp != '\0') || (n < 1) || (nProc < 1) || (spin < 0)) {
+            fprintf (stderr, "Invalid option value!\n");
+            return EXIT_FAILURE;
+        }
+    }
+
+    if ((key = ftok (".", 'b')) == -1) {
+        perror ("error on generating the key");
+        return EXIT_FAILURE;
+    }
+    check (shmid = shmemCreate (key, sizeof (BENCH_DATA)), "error on creating the shared memory region");
+    check (shmemAttach (shmid, (void **) &bd), "error on mapping the shared region");
+    check (semgid = semCreate (key, NSEM), "error on creating the semaphore set");
+    check (semSignal (semgid), "error on signaling start of operations");
+    bd->counter = 0;
+
+    /* uncontended operations */
+
+    t0 = now ();
+    for (i = 0; i < n; i++) {
+        check (semUp (semgid, PING), "error on the up operation");
+        check (semDown (semgid, PING), "error on the down operation");
+    }
+    report ("updown", t0, n);
+
+    /* two processes waking each other up (the set and the region are inherited by the child) */
+
+    t0 = now ();
+    switch (fork ()) {
+    case -1:
+        check (-1, "error on the fork operation");
+        break;
+    case 0:
+        for (i = 0; i < n; i++) {
+            check (semDown (semgid, PING), "error on the down operation");
+            check (semUp (semgid, PONG), "error on the up operation");
+        }
+        exit (EXIT_SUCCESS);
+    }
+    for (i = 0; i < n; i++) {
+        check (semUp (semgid, PING), "error on the up operation");
+        check (semDown (semgid, PONG), "error on the down operation");
+    }
+    waitChildren (1);
+    report ("pingpong", t0, n);
+
+    /* critical region shared by several processes */
+
+    check (semUp (semgid, LOCK), "error on the up operation");
+    check (semSetSpin (semgid, LOCK, (unsigned int) spin), "error on setting the spin limit");
+    t0 = now ();
+    for (p = 0; p < nProc; p++) {
+        switch (fork ()) {
+        case -1:
+            check (-1, "error on the fork operation");
+            break;
+        case 0:
+            for (i = p; i < n; i += nProc) {
+                check (semDown (semgid, LOCK), "error on the down operation");
+                bd->counter += 1;
+                check (semUp (semgid, LOCK), "error on the up operation");
+            }
+            exit (EXIT_SUCCESS);
+        }
+    }
+    waitChildren (nProc);
+    report ("mutex", t0, n);
+    if (spin > 0) {
+        check (semSpinStats (semgid, LOCK, &stats), "error on getting the spin counters");
+        printf ("%-6s %-9s %10lu entries after spinning, %lu blocks (spin limit %ld)\n", BACKEND, "spin", stats.nSpinAcquired,
+                stats.nBlocked, spin);
+    }
+    if (bd->counter != (unsigned long) n) {
+        fprintf (stderr, "Mutual exclusion failed: counter is %lu instead of %ld!\n", bd->counter, n);
+        return EXIT_FAILURE;
+    }
+
+    check (semDestroy (semgid), "error on destructing the semaphore set");
+    check (shmemDettach (bd), "error on unmapping the shared region");
+    check (shmemDestroy (shmid), "error on destructing the shared region");
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,95 @@
+/**
+ *  \file semCount.c (implementation file)
+ *
+ *  \brief Problem name: Air Lift.
+ *
+ *  Counter of the semaphore system calls of a process.
+ *
+ *  Shared library to be preloaded (<tt>LD_PRELOAD</tt>) when running the simulation built with the SVIPC
+ *  semaphores (see the <tt>count</tt> target of the Makefile and <tt>semCount.sh</tt>). The calls to
+ *  <tt>semop</tt> and <tt>semtimedop</tt> are counted and, upon termination, a line with the name of the program
+ *  and the number of calls is appended to the file named in the environment variable <tt>SEMCOUNT_LOG</tt>.
+ */
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dlfcn.h>
+#include <sys/types.h>
+#include <sys/ipc.h>
+#include <sys/sem.h>
+
+/** \brief number of semaphore system calls carried out by the process */
+static unsigned long nCalls = 0;
+
+/**
+ *  \brief Getting the libc function a wrapper stands for.
+ *
+ *  \param name function name
+ */
+
+static void *next (const char *name)
+{
+    void *f;
+
+    if ((f = dlsym (RTLD_NEXT, name)) == NULL) {
+        fprintf (stderr, "semCount: %s not found\n", name);
+        _exit (EXIT_FAILURE);
+    }
+    return f;
+}
+
+/**
+ *  \brief Wrapper of <tt>semop</tt>.
+ */
+
+int semop (int semid, struct sembuf *sops, size_t nsops)
+{
+    static int (*real) (int, struct sembuf *, size_t) = NULL;
+
+    if (real == NULL) {
+        real = (int (*) (int, struct sembuf *, size_t)) next ("semop");
+    }
+    nCalls += 1;
+    return real (semid, sops, nsops);
+}
+
+/**
+ *  \brief Wrapper of <tt>semtimedop</tt>.
+ */
+
+int semtimedop (int semid, struct sembuf *sops, size_t nsops, const struct timespec *timeout)
+{
+    static int (*real) (int, struct sembuf *, size_t, const struct timespec *) = NULL;
+
+    if (real == NULL) {
+        real = (int (*) (int, struct sembuf *, size_t, const struct timespec *)) next ("semtimedop");
+    }
+    nCalls += 1;
+    return real (semid, sops, nsops, timeout);
+}
+
+/**
+ *  \brief Appending the number of calls to the counting file, upon termination.
+ */
+
+static void __attribute__ ((destructor)) report (void)
+{
+    const char *name = getenv ("SEMCOUNT_LOG");
+    char line[128];
+    int fd, len, err = errno;
+
+    if ((name == NULL) || ((fd = open (name, O_WRONLY | O_CREAT | O_APPEND, 0600)) == -1)) {
+        return;
+    }
+    len = snprintf (line, sizeof (line), "%s %lu\n", program_invocation_short_name, nCalls);
+    if (write (fd, line, (size_t) len) != len) {                                  /* a single write, not interleaved */
+        perror ("semCount: error on writing the counting file");
+    }
+    close (fd);
+    errno = err;
+}
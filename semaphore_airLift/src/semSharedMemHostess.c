@@ -29,12 +29,15 @@
 #include "sharedDataSync.h"
 #include "semaphore.h"
 #include "sharedMemory.h"
+#include "entityThreads.h"
 
 /** \brief logging file name */
 static char nFic[51];
 
+#ifndef THREADED
 /** \brief shared memory block access identifier */
 static int shmid;
+#endif
 
 /** \brief semaphore set access identifier */
 static int semgid;
@@ -61,6 +64,25 @@ static int nPassengersInFlight ();
 /** \brief getter for number of passengers waiting */
 static int nPassengersInQueue ();
 
+#ifdef THREADED
+
+/**
+ *  \brief Binding the hostess to the region and the semaphore set of the generator (threaded build).
+ *
+ *  \param logName name of the logging file
+ *  \param sgid semaphore set access identifier
+ *  \param shared pointer to the shared region
+ */
+
+void hostessBind (char logName[], int sgid, SHARED_DATA *shared)
+{
+    strcpy (nFic, logName);
+    semgid = sgid;
+    sh = shared;
+}
+
+#else
+
 /**
  *  \brief Main program.
  *
@@ -74,7 +96,7 @@ int main (int argc, char *argv[])
 
     /* validation of command line parameters */
 
-    if (argc != 4) { 
+    if ((argc != 4) && (argc != 5)) { 
         freopen ("error_HT", "a", stderr);
         fprintf (stderr, "Number of parameters is incorrect!\n");
         return EXIT_FAILURE;
@@ -87,6 +109,15 @@ int main (int argc, char *argv[])
     { fprintf (stderr, "Error on the access key communication!\n");
         return EXIT_FAILURE;
     }
+    if (argc == 5) {                                                               /* optional logging level */
+        unsigned int level = (unsigned int) strtol (argv[4], &tinp, 0);
+
+        if ((*tinp != '\0') || (level > LOG_LEVEL_FULL)) {
+            fprintf (stderr, "Error on the logging level communication!\n");
+            return EXIT_FAILURE;
+        }
+        setLogLevel (level);
+    }
 
     /* connection to the semaphore set and the shared memory region and mapping the shared region onto the
        process address space */
@@ -103,14 +134,39 @@ int main (int argc, char *argv[])
         perror ("error on mapping the shared region on the process address space");
         return EXIT_FAILURE;
     }
+    openLogSession (nFic, &sh->log);                                   /* the log file is kept open for the whole run */
 
     srandom ((unsigned int) getpid ());                                                 /* initialize random generator */
 
     /* simulation of the life cycle of the hostess */
 
+    hostessLife ();
+
+    closeLogSession ();
+
+    /* unmapping the shared region off the process address space */
+
+    if (shmemDettach (sh) == -1) {
+        perror ("error on unmapping the shared region off the process address space");
+        return EXIT_FAILURE;;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+#endif /* THREADED */
+
+/**
+ *  \brief Life cycle of the hostess.
+ */
+
+void hostessLife (void)
+{
     int nPassengers=0;
     bool lastPassengerInFlight;
 
+    semStatsAttach (&sh->semStats, STATS_HOSTESS);                            /* nothing, unless built with SEM_STATS */
+
     while(nPassengers < N ) {
         waitForNextFlight();
         do { 
@@ -119,16 +175,8 @@ int main (int argc, char *argv[])
             nPassengers++;
         } while (!lastPassengerInFlight);
         signalReadyToFlight();
+        flushLog();                                                          /* flight boundary, outside the region */
     }
-
-    /* unmapping the shared region off the process address space */
-
-    if (shmemDettach (sh) == -1) {
-        perror ("error on unmapping the shared region off the process address space");
-        return EXIT_FAILURE;;
-    }
-
-    return EXIT_SUCCESS;
 }
 
 /**
@@ -145,6 +193,7 @@ static void waitForNextFlight ()
         perror ("error on the up operation for semaphore access (HT)");
         exit (EXIT_FAILURE);
     }
+    seqWriteBegin (&sh->fStSeq);
 
     /* insert your code here */
     //hostess muda para o estado WAIT_FOR_FLIGHT. O estado é guardado
@@ -152,6 +201,7 @@ static void waitForNextFlight ()
     saveState(nFic, &sh->fSt);
     
     
+    seqWriteEnd (&sh->fStSeq);
     if (semUp (semgid, sh->mutex) == -1)                                                   /* exit critical region */
     { perror ("error on the down operation for semaphore access (HT)");
         exit (EXIT_FAILURE);
@@ -178,6 +228,7 @@ static void waitForPassenger ()
     { perror ("error on the up operation for semaphore access (HT)");
         exit (EXIT_FAILURE);
     }
+    seqWriteBegin (&sh->fStSeq);
 
     /* insert your code here */
     //hostess muda o seu estado para WAIT_FOR_PASSENGER
@@ -185,6 +236,7 @@ static void waitForPassenger ()
     saveState(nFic, &sh->fSt);
     
 
+    seqWriteEnd (&sh->fStSeq);
     if (semUp (semgid, sh->mutex) == -1) {                                                  /* exit critical region */
      perror ("error on the down operation for semaphore access (HT)");
         exit (EXIT_FAILURE);
@@ -216,19 +268,14 @@ static bool checkPassport()
     bool last;
 
     /* insert your code here */
-    //hostess atende o passageiro
-    if (semUp (semgid, sh->passengersWaitInQueue) == -1)                                                     
-    { perror ("erro a desbloquear semáforo que informa a hostess que há passageiros na fila à espera dela");
-        exit (EXIT_FAILURE);
-    }
-    
-    
+    //hostess atende o passageiro e entra na região crítica
+    SEM_OP call[2] = {{ sh->passengersWaitInQueue, 1 }, { sh->mutex, -1 }};
 
-    if (semDown (semgid, sh->mutex) == -1) {                                                     /* enter critical region */
-        perror ("error on the up operation for semaphore access (HT)");
+    if (semOps (semgid, call, 2) == -1) {                                                     /* enter critical region */
+        perror ("erro a desbloquear semáforo que informa a hostess que há passageiros na fila à espera dela");
         exit (EXIT_FAILURE);
-
     }
+    seqWriteBegin (&sh->fStSeq);
 
     /* insert your code here */
     //hostess muda para o estado CHECK_PASSPORT. O estado é guardado
@@ -236,26 +283,21 @@ static bool checkPassport()
     saveState(nFic, &sh->fSt);
     
 
+    seqWriteEnd (&sh->fStSeq);
     if (semUp (semgid, sh->mutex) == -1)     {                                                 /* exit critical region */
         perror ("error on the up operation for semaphore access (HT)");
         exit (EXIT_FAILURE);
     }
 
     /* insert your code here */
-    //hostess espera que o passageiro lhe dê o passaporte para ela verificar
-    if (semDown (semgid, sh->idShown) == -1)                                                     
-    { perror ("erro a bloquear semáforo que permite a hostess verificar o passaporte");
-        exit (EXIT_FAILURE);
-    }
-    
-    
-    
+    //hostess espera que o passageiro lhe dê o passaporte para ela verificar, e entra na região crítica
+    SEM_OP shown[2] = {{ sh->idShown, -1 }, { sh->mutex, -1 }};
 
-    if (semDown (semgid, sh->mutex) == -1)  {                                                 /* enter critical region */
-        perror ("error on the up operation for semaphore access (HT)");
+    if (semOps (semgid, shown, 2) == -1) {                                                    /* enter critical region */
+        perror ("erro a bloquear semáforo que permite a hostess verificar o passaporte");
         exit (EXIT_FAILURE);
-
     }
+    seqWriteBegin (&sh->fStSeq);
 
     /* insert your code here */
     //atualização do nº de passageiros na fila de espera e no avião e devido registo
@@ -279,6 +321,7 @@ static bool checkPassport()
     
     
 
+    seqWriteEnd (&sh->fStSeq);
     if (semUp (semgid, sh->mutex) == -1) {                                                     /* exit critical region */
         perror ("error on the up operation for semaphore access (HT)");
         exit (EXIT_FAILURE);
@@ -315,6 +358,7 @@ void  signalReadyToFlight()
         perror ("error on the up operation for semaphore access (HT)");
         exit (EXIT_FAILURE);
     }
+    seqWriteBegin (&sh->fStSeq);
 
     /* insert your code here */
     //hostess muda para o estado READY_TO_FLIGHT, regista o número de passageiros no voo, e o estado é guardado. Para que o output entre este programa e o pre-compilado sejam mais idênticos, o log do FlightDeparted é feito aqui.
@@ -330,16 +374,14 @@ void  signalReadyToFlight()
     
     
 
-    if (semUp (semgid, sh->mutex) == -1) {                                                     /* exit critical region */
-        perror ("error on the up operation for semaphore access (HT)");
-        exit (EXIT_FAILURE);
-    }
-
     /* insert your code here */
-    //hostess informa piloto que embarque terminou
-    if (semUp (semgid, sh->readyToFlight) == -1) {                                                     
+    //hostess sai da região crítica e informa piloto que embarque terminou
+    seqWriteEnd (&sh->fStSeq);
+    SEM_OP ready[2] = {{ sh->mutex, 1 }, { sh->readyToFlight, 1 }};
+
+    if (semOps (semgid, ready, 2) == -1) {                                                     /* exit critical region */
         perror ("erro a desbloquear semáforo que faz o piloto esperar pelo término do embarque");
-    exit (EXIT_FAILURE);
+        exit (EXIT_FAILURE);
     }
 }
 
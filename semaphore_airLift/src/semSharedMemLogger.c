@@ -0,0 +1,99 @@
+/**
+ *  \file semSharedMemLogger.c (implementation file)
+ *
+ *  \brief Problem name: Air Lift
+ *
+ *  Synchronization based on semaphores and shared memory.
+ *  Implementation with SVIPC.
+ *
+ *  Logger process of the asynchronous logging build (<tt>LOG_ASYNC</tt>).
+ *
+ *  It is the only writer of the logging file: the intervening entities push their event records into a
+ *  lock-free queue in shared memory and the logger prints them in large blocks.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <string.h>
+
+#include "probConst.h"
+#include "probDataStruct.h"
+#include "logging.h"
+#include "sharedDataSync.h"
+#include "semaphore.h"
+#include "sharedMemory.h"
+
+#ifndef LOG_ASYNC
+#error "the logger process is only used by the asynchronous logging build (make asynclog)"
+#endif
+
+/** \brief logging file name */
+static char nFic[51];
+
+/** \brief shared memory block access identifier */
+static int shmid;
+
+/** \brief semaphore set access identifier */
+static int semgid;
+
+/** \brief pointer to shared memory region */
+static SHARED_DATA *sh;
+
+/**
+ *  \brief Main program.
+ *
+ *  Its role is to serve the queue of event records until the air lift is over.
+ */
+
+int main (int argc, char *argv[])
+{
+    int key;                                                           /*access key to shared memory and semaphore set */
+    char *tinp;                                                                      /* numerical parameters test flag */
+
+    /* validation of command line parameters */
+
+    if (argc != 4) { 
+        freopen ("error_LG", "a", stderr);
+        fprintf (stderr, "Number of parameters is incorrect!\n");
+        return EXIT_FAILURE;
+    }
+    else freopen (argv[3], "w", stderr);
+    strcpy (nFic, argv[1]);
+    key = (unsigned int) strtol (argv[2], &tinp, 0);
+    if (*tinp != '\0') {
+        fprintf (stderr, "Error on the access key communication!\n");
+        return EXIT_FAILURE;
+    }
+
+    /* connection to the semaphore set and the shared memory region and mapping the shared region onto the
+       process address space */
+
+    if ((semgid = semConnect (key)) == -1) { 
+        perror ("error on connecting to the semaphore set");
+        return EXIT_FAILURE;
+    }
+    if ((shmid = shmemConnect (key)) == -1) { 
+        perror ("error on connecting to the shared memory region");
+        return EXIT_FAILURE;
+    }
+    if (shmemAttach (shmid, (void **) &sh) == -1) { 
+        perror ("error on mapping the shared region on the process address space");
+        return EXIT_FAILURE;
+    }
+
+    /* service of the queue of event records */
+
+    serveLog (nFic, &sh->log);
+
+    /* unmapping the shared region off the process address space */
+
+    if (shmemDettach (sh) == -1) { 
+        perror ("error on unmapping the shared region off the process address space");
+        return EXIT_FAILURE;;
+    }
+
+    return EXIT_SUCCESS;
+}
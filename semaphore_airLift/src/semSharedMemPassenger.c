@@ -11,6 +11,11 @@
  *     \li waitInQueue
  *     \li waitUntilDestination
  *
+ *  When built with <tt>ATOMIC_COUNTERS</tt> and run at the summary logging level, no logged line shows the counters
+ *  of passengers, so the passenger joins the queue and leaves the plane without entering the critical region: its
+ *  own state is a field no one else writes and the counters are updated with atomic operations. The hostess keeps
+ *  updating them inside the critical region, where her decision on the last passenger of a flight is taken.
+ *
  *  \author Nuno Lau - January 2022
  */
 
@@ -28,12 +33,15 @@
 #include "sharedDataSync.h"
 #include "semaphore.h"
 #include "sharedMemory.h"
+#include "entityThreads.h"
 
 /** \brief logging file name */
 static char nFic[51];
 
+#ifndef THREADED
 /** \brief shared memory block access identifier */
 static int shmid;
+#endif
 
 /** \brief semaphore set access identifier */
 static int semgid;
@@ -41,11 +49,38 @@ static int semgid;
 /** \brief pointer to shared memory region */
 static SHARED_DATA *sh;
 
+#ifdef ATOMIC_COUNTERS
+/** \brief the counters are updated outside the critical region (no logged line shows them) */
+static bool lockFree = false;
+#endif
+
 static bool travelToAirport ();
 static void waitInQueue (unsigned int passengerId);
 static void waitUntilDestination (unsigned int passengerId);
 static void leavePlane (unsigned int passengerId);
 
+#ifdef THREADED
+
+/**
+ *  \brief Binding the passenger to the region and the semaphore set of the generator (threaded build).
+ *
+ *  \param logName name of the logging file
+ *  \param sgid semaphore set access identifier
+ *  \param shared pointer to the shared region
+ */
+
+void passengerBind (char logName[], int sgid, SHARED_DATA *shared)
+{
+    strcpy (nFic, logName);
+    semgid = sgid;
+    sh = shared;
+#ifdef ATOMIC_COUNTERS
+    lockFree = (getLogLevel () < LOG_LEVEL_EVENTS);
+#endif
+}
+
+#else
+
 /**
  *  \brief Main program.
  *
@@ -60,7 +95,7 @@ int main (int argc, char *argv[])
 
     /* validation of command line parameters */
 
-    if (argc != 5) { 
+    if ((argc != 5) && (argc != 6)) { 
         freopen ("error_PG", "a", stderr);
         fprintf (stderr, "Number of parameters is incorrect!\n");
         return EXIT_FAILURE;
@@ -78,6 +113,18 @@ int main (int argc, char *argv[])
         fprintf (stderr, "Error on the access key communication!\n");
         return EXIT_FAILURE;
     }
+    if (argc == 6) {                                                               /* optional logging level */
+        unsigned int level = (unsigned int) strtol (argv[5], &tinp, 0);
+
+        if ((*tinp != '\0') || (level > LOG_LEVEL_FULL)) {
+            fprintf (stderr, "Error on the logging level communication!\n");
+            return EXIT_FAILURE;
+        }
+        setLogLevel (level);
+    }
+#ifdef ATOMIC_COUNTERS
+    lockFree = (getLogLevel () < LOG_LEVEL_EVENTS);
+#endif
 
     /* connection to the semaphore set and the shared memory region and mapping the shared region onto the
        process address space */
@@ -94,15 +141,16 @@ int main (int argc, char *argv[])
         perror ("error on mapping the shared region on the process address space");
         return EXIT_FAILURE;
     }
+    openLogSession (nFic, &sh->log);                                   /* the log file is kept open for the whole run */
 
     srandom ((unsigned int) getpid ());                                                 /* initialize random generator */
 
 
     /* simulation of the life cycle of the passenger */
 
-    travelToAirport();
-    waitInQueue(n);
-    waitUntilDestination(n);
+    passengerLife (n);
+
+    closeLogSession ();
 
     /* unmapping the shared region off the process address space */
 
@@ -114,6 +162,23 @@ int main (int argc, char *argv[])
     return EXIT_SUCCESS;
 }
 
+#endif /* THREADED */
+
+/**
+ *  \brief Life cycle of a passenger.
+ *
+ *  \param passengerId passenger id
+ */
+
+void passengerLife (unsigned int passengerId)
+{
+    semStatsAttach (&sh->semStats, STATS_PASSENGER);                          /* nothing, unless built with SEM_STATS */
+
+    travelToAirport();
+    waitInQueue(passengerId);
+    waitUntilDestination(passengerId);
+}
+
 
 /**
  *  \brief passenger goes to airport
@@ -140,49 +205,52 @@ static bool travelToAirport ()
 
 static void waitInQueue (unsigned int passengerId)
 {
-    if (semDown (semgid, sh->mutex) == -1) {                                                  /* enter critical region */
-        perror ("error on the down operation for semaphore access (PG)");
-        exit (EXIT_FAILURE);
+#ifdef ATOMIC_COUNTERS
+    if (lockFree) {                                                  /* joining the queue, outside the critical region */
+        sh->fSt.st.passengerStat[passengerId]=IN_QUEUE;
+        atomic_fetch_add (&sh->fSt.nPassInQueue, 1);
+        if (semUp (semgid, sh->passengersInQueue) == -1) {
+            perror ("error on the up operation for semaphore access (PG)");
+            exit (EXIT_FAILURE);
+        }
     }
-
-    /* insert your code here */
+    else
+#endif
+    {
+        if (semDown (semgid, sh->mutex) == -1) {                                              /* enter critical region */
+            perror ("error on the down operation for semaphore access (PG)");
+            exit (EXIT_FAILURE);
+        }
+        seqWriteBegin (&sh->fStSeq);
+
+        /* insert your code here */
     
-    //passageiro muda para o estado IN_QUEUE, e incrementa o nPassInQueue
-    sh->fSt.st.passengerStat[passengerId]=IN_QUEUE;
-    sh->fSt.nPassInQueue+=1;
-    saveState(nFic, &sh->fSt);
-
-    if (semUp (semgid, sh->mutex) == -1)                                                      /* exit critical region */
-    { perror ("error on the up operation for semaphore access (PG)");
-        exit (EXIT_FAILURE);
-    }
-
-    /* insert your code here */
-    //passageiro informa que há passageiros na fila
-    if (semUp (semgid, sh->passengersInQueue) == -1)                                                     
-    { perror ("erro a desbloquear semáforo que informa a existência há passageiros na fila");
-        exit (EXIT_FAILURE);
-    }
-    
-    //passageiro informa hostess que está à espera dela
-    if (semDown (semgid, sh->passengersWaitInQueue) == -1)                                                     
-    { perror ("erro a bloquear semáforo que informa a hostess que há passageiros na fila");
-        exit (EXIT_FAILURE);
+        //passageiro muda para o estado IN_QUEUE, e incrementa o nPassInQueue
+        sh->fSt.st.passengerStat[passengerId]=IN_QUEUE;
+        sh->fSt.nPassInQueue+=1;
+        saveState(nFic, &sh->fSt);
+
+        /* insert your code here */
+        //passageiro sai da região crítica e informa que há passageiros na fila, com uma única operação
+        seqWriteEnd (&sh->fStSeq);
+        SEM_OP inQueue[2] = {{ sh->mutex, 1 }, { sh->passengersInQueue, 1 }};
+
+        if (semOps (semgid, inQueue, 2) == -1)                                                /* exit critical region */
+        { perror ("erro a desbloquear semáforo que informa a existência há passageiros na fila");
+            exit (EXIT_FAILURE);
+        }
     }
-   
     
+    //passageiro espera pela hostess e entra na região crítica (nenhum semáforo é retido enquanto bloqueia)
+    SEM_OP called[2] = {{ sh->passengersWaitInQueue, -1 }, { sh->mutex, -1 }};
 
-    if (semDown (semgid, sh->mutex) == -1) {                                                  /* enter critical region */
-        perror ("error on the down operation for semaphore access (PG)");
+    if (semOps (semgid, called, 2) == -1) {                                                  /* enter critical region */
+        perror ("erro a bloquear semáforo que informa a hostess que há passageiros na fila");
         exit (EXIT_FAILURE);
-    }    
+    }
+    seqWriteBegin (&sh->fStSeq);
 
     /* insert your code here */
-    //passageiro dá permissão à hostess para lhe verificar o ID
-    if (semUp (semgid, sh->idShown) == -1)                                                     
-    { perror ("erro a desbloquear semáforo que permite a hostess verificar o passaporte");
-        exit (EXIT_FAILURE);
-    }
     //id do último passageiro a ter o passaporte verificado
     sh->fSt.passengerChecked=passengerId;
     
@@ -196,8 +264,12 @@ static void waitInQueue (unsigned int passengerId)
     //savePassengerChecked(nFic, &sh->fSt); //a hospedeira faz este log
     
 
-    if (semUp (semgid, sh->mutex) == -1) {                                                  /* enter critical region */
-        perror ("error on the down operation for semaphore access (PG)");
+    //passageiro dá permissão à hostess para lhe verificar o ID ao sair da região crítica (ela tem de entrar nela a seguir)
+    seqWriteEnd (&sh->fStSeq);
+    SEM_OP shown[2] = {{ sh->idShown, 1 }, { sh->mutex, 1 }};
+
+    if (semOps (semgid, shown, 2) == -1) {                                                  /* exit critical region */
+        perror ("erro a desbloquear semáforo que permite a hostess verificar o passaporte");
         exit (EXIT_FAILURE);
     }
 
@@ -218,20 +290,31 @@ static void waitInQueue (unsigned int passengerId)
 
 static void waitUntilDestination (unsigned int passengerId)
 {
-
-    /* insert your code here */
-    //passageiros esperam que o voo termine
-    if (semDown (semgid, sh->passengersWaitInFlight) == -1) {                                                 
-        perror ("error a bloquear semáforo para os passageiros esperarem pelo fim do voo");
-        exit (EXIT_FAILURE);
+#ifdef ATOMIC_COUNTERS
+    if (lockFree) {                                                 /* leaving the plane, outside the critical region */
+        if (semDown (semgid, sh->passengersWaitInFlight) == -1) {
+            perror ("error on the down operation for semaphore access (PG)");
+            exit (EXIT_FAILURE);
+        }
+        sh->fSt.st.passengerStat[passengerId]=AT_DESTINATION;
+        /* the passenger that brings the counter down to 0 is the last one */
+        if ((atomic_fetch_sub (&sh->fSt.nPassInFlight, 1) == 1) && (semUp (semgid, sh->planeEmpty) == -1)) {
+            perror ("error on the up operation for semaphore access (PG)");
+            exit (EXIT_FAILURE);
+        }
+        return;
     }
-    
+#endif
 
+    /* insert your code here */
+    //passageiros esperam que o voo termine e entram na região crítica
+    SEM_OP landed[2] = {{ sh->passengersWaitInFlight, -1 }, { sh->mutex, -1 }};
 
-    if (semDown (semgid, sh->mutex) == -1) {                                                  /* enter critical region */
-        perror ("error on the down operation for semaphore access (PG)");
+    if (semOps (semgid, landed, 2) == -1) {                                                  /* enter critical region */
+        perror ("error a bloquear semáforo para os passageiros esperarem pelo fim do voo");
         exit (EXIT_FAILURE);
     }
+    seqWriteBegin (&sh->fStSeq);
 
     /* insert your code here */
     //passageiros mudam de estado para AT_DESTINATION, e decrementam nº de passageiros em voo
@@ -241,16 +324,12 @@ static void waitUntilDestination (unsigned int passengerId)
     saveState(nFic, &sh->fSt);
     
     
-    //último passageiro diz se é o último
-    if (sh->fSt.nPassInFlight==0) {
-	    if (semUp (semgid, sh->planeEmpty) == -1) {                                                 
-		perror ("erro a desbloquear semáforo que informa se o avião está vazio");
-		exit (EXIT_FAILURE);
-	    }
-    }
+    //último passageiro diz se é o último, ao sair da região crítica
+    seqWriteEnd (&sh->fStSeq);
+    SEM_OP leave[2] = {{ sh->planeEmpty, (sh->fSt.nPassInFlight==0) ? 1 : 0 }, { sh->mutex, 1 }};
 
-    if (semUp (semgid, sh->mutex) == -1) {                                                  /* enter critical region */
-        perror ("error on the down operation for semaphore access (PG)");
+    if (semOps (semgid, leave, 2) == -1) {                                                  /* exit critical region */
+        perror ("erro a desbloquear semáforo que informa se o avião está vazio");
         exit (EXIT_FAILURE);
     }
 
@@ -32,13 +32,16 @@
 #include "sharedDataSync.h"
 #include "semaphore.h"
 #include "sharedMemory.h"
+#include "entityThreads.h"
 
 
 /** \brief logging file name */
 static char nFic[51];
 
+#ifndef THREADED
 /** \brief shared memory block access identifier */
 static int shmid;
+#endif
 
 /** \brief semaphore set access identifier */
 static int semgid;
@@ -52,6 +55,25 @@ static void waitUntilReadyToFlight ();
 static void dropPassengersAtTarget ();
 static bool isFinished ();
 
+#ifdef THREADED
+
+/**
+ *  \brief Binding the pilot to the region and the semaphore set of the generator (threaded build).
+ *
+ *  \param logName name of the logging file
+ *  \param sgid semaphore set access identifier
+ *  \param shared pointer to the shared region
+ */
+
+void pilotBind (char logName[], int sgid, SHARED_DATA *shared)
+{
+    strcpy (nFic, logName);
+    semgid = sgid;
+    sh = shared;
+}
+
+#else
+
 /**
  *  \brief Main program.
  *
@@ -65,7 +87,7 @@ int main (int argc, char *argv[])
 
     /* validation of command line parameters */
 
-    if (argc != 4) { 
+    if ((argc != 4) && (argc != 5)) { 
         freopen ("error_PT", "a", stderr);
         fprintf (stderr, "Number of parameters is incorrect!\n");
         return EXIT_FAILURE;
@@ -77,6 +99,15 @@ int main (int argc, char *argv[])
         fprintf (stderr, "Error on the access key communication!\n");
         return EXIT_FAILURE;
     }
+    if (argc == 5) {                                                               /* optional logging level */
+        unsigned int level = (unsigned int) strtol (argv[4], &tinp, 0);
+
+        if ((*tinp != '\0') || (level > LOG_LEVEL_FULL)) {
+            fprintf (stderr, "Error on the logging level communication!\n");
+            return EXIT_FAILURE;
+        }
+        setLogLevel (level);
+    }
 
     /* connection to the semaphore set and the shared memory region and mapping the shared region onto the
        process address space */
@@ -93,18 +124,15 @@ int main (int argc, char *argv[])
         perror ("error on mapping the shared region on the process address space");
         return EXIT_FAILURE;
     }
+    openLogSession (nFic, &sh->log);                                   /* the log file is kept open for the whole run */
 
     srandom ((unsigned int) getpid ());                                                 /* initialize random generator */
 
     /* simulation of the life cycle of the pilot */
 
-    while(!isFinished()) {
-        flight(false); // from target to origin
-        signalReadyForBoarding();
-        waitUntilReadyToFlight();
-        flight(true); // from origin to target
-        dropPassengersAtTarget();
-    }
+    pilotLife ();
+
+    closeLogSession ();
 
     /* unmapping the shared region off the process address space */
 
@@ -116,6 +144,26 @@ int main (int argc, char *argv[])
     return EXIT_SUCCESS;
 }
 
+#endif /* THREADED */
+
+/**
+ *  \brief Life cycle of the pilot.
+ */
+
+void pilotLife (void)
+{
+    semStatsAttach (&sh->semStats, STATS_PILOT);                              /* nothing, unless built with SEM_STATS */
+
+    while(!isFinished()) {
+        flight(false); // from target to origin
+        signalReadyForBoarding();
+        waitUntilReadyToFlight();
+        flight(true); // from origin to target
+        dropPassengersAtTarget();
+        flushLog();                                                          /* flight boundary, outside the region */
+    }
+}
+
 /**
  *  \brief test if air lift finished
  */
@@ -140,6 +188,7 @@ static void flight (bool go)
         perror ("error on the up operation for semaphore access (PT)");
         exit (EXIT_FAILURE);
     }
+    seqWriteBegin (&sh->fStSeq);
 
     /* insert your code here */
     //se "go" for falso, mudar estado do piloto para 0 (voo para origem). Caso contrário, mudar para 3 (voo para o destino). Escrever no log as alterações
@@ -157,6 +206,7 @@ static void flight (bool go)
     	saveState(nFic, &sh->fSt);
     }
 
+    seqWriteEnd (&sh->fStSeq);
     if (semUp (semgid, sh->mutex) == -1) {                                                      /* exit critical region */
         perror ("error on the up operation for semaphore access (PT)");
         exit (EXIT_FAILURE);
@@ -180,6 +230,7 @@ static void signalReadyForBoarding ()
         perror ("error on the up operation for semaphore access (PT)");
         exit (EXIT_FAILURE);
     }
+    seqWriteBegin (&sh->fStSeq);
 
     /* insert your code here */
     //o piloto atualiza o seu estado para 1 (READY_FOR_BOARDING). O número do voo é incrementado por 1. O estado é guardado, e é apresentada uma mensagem de início o embarque
@@ -189,16 +240,14 @@ static void signalReadyForBoarding ()
     saveStartBoarding(nFic, &sh->fSt);
     
 
-    if (semUp (semgid, sh->mutex) == -1) {                                                      /* exit critical region */
-        perror ("error on the up operation for semaphore access (PT)");
-        exit (EXIT_FAILURE);
-    }
-
     /* insert your code here */
-    //A hostess pode começar operações de embarque
-    if (semUp (semgid, sh->readyForBoarding) == -1) {                                                      
+    //o piloto sai da região crítica e a hostess pode começar operações de embarque
+    seqWriteEnd (&sh->fStSeq);
+    SEM_OP ready[2] = {{ sh->mutex, 1 }, { sh->readyForBoarding, 1 }};
+
+    if (semOps (semgid, ready, 2) == -1) {                                                      /* exit critical region */
         perror ("erro a desbloquear semáforo que indica a hostess que o embarque pode começar");
-    exit (EXIT_FAILURE);
+        exit (EXIT_FAILURE);
     }
 
 }
@@ -216,12 +265,14 @@ static void waitUntilReadyToFlight ()
         perror ("error on the up operation for semaphore access (PT)");
         exit (EXIT_FAILURE);
     }
+    seqWriteBegin (&sh->fStSeq);
 
     /* insert your code here */
     //piloto muda de estado para 2 (WAITING_FOR_BOARDING)
     sh->fSt.st.pilotStat=WAITING_FOR_BOARDING;
     saveState(nFic, &sh->fSt);
 
+    seqWriteEnd (&sh->fStSeq);
     if (semUp (semgid, sh->mutex) == -1) {                                                      /* exit critical region */
         perror ("error on the up operation for semaphore access (PT)");
         exit (EXIT_FAILURE);
@@ -250,6 +301,7 @@ static void dropPassengersAtTarget ()
         perror ("error on the down operation for semaphore access (PT)");
         exit (EXIT_FAILURE);
     }
+    seqWriteBegin (&sh->fStSeq);
 
     /* insert your code here */
     //é apresentada a informação de que o voo chegou. O piloto muda para o estado 4 (DROPING_PASSENGERS), e o estado é guardado
@@ -259,39 +311,24 @@ static void dropPassengersAtTarget ()
     
     
     
-    if (semUp (semgid, sh->mutex) == -1)  {                                                   /* exit critical region */
-        perror ("error on the up operation for semaphore access (PT)");
+    /* insert your code here */
+        //o piloto sinaliza os passageiros que podem sair do avião, ao sair da região crítica. Como cada passageiro faz um Down(), também temos que fazer um Up() por passageiro; o nº de passageiros em voo é lido ainda dentro da região crítica, para que não seja inconsistente
+    seqWriteEnd (&sh->fStSeq);
+    SEM_OP drop[2] = {{ sh->mutex, 1 }, { sh->passengersWaitInFlight, sh->fSt.nPassInFlight }};
+
+    if (semOps (semgid, drop, 2) == -1)  {                                                   /* exit critical region */
+        perror ("erro ao desbloquear semáforo que sinaliza passageiros que podem abandonar o avião");
         exit (EXIT_FAILURE);
     }
 
-	
-    /* insert your code here */
-        //o piloto sinaliza os passageiros que podem sair do avião. Como cada passageiro faz um Down(), também temos que fazer um Up() por passageiro. Para evitar deadlocks e condições de corrida, esta secção inteira deve estar dentro da região crítica, para que o nPassInFlight não seja inconsistente entre interações. Alternativamente, simplesmete fixa-se o nº inicial de passageiros em voo antes de se fazerem as iterações
-        
-        int passageiros=sh->fSt.nPassInFlight;
-        
-        for (int i=0; i<passageiros; i++) {
-	    if (semUp (semgid, sh->passengersWaitInFlight) == -1)  {                                                 
-		perror ("erro ao desbloquear semáforo que sinaliza passageiros que podem abandonar o avião");
-		exit (EXIT_FAILURE);
-	    }
-	    //printf("Up %d\n", i);
-     }
-
-
-	//o piloto só parte quando o semáfoto planeEmpty estiver desbloqueado. Se a thread do piloto chegar aqui primeiro do que a thread do último passageiro, o piloto bloqueia à espera do último passageiro, e depois deste desbloquear o semáforo, o piloto prossegue. Se a thread do último passageiro chegar primeiro, o piloto quando chegar não espera, mas também já não tem que esperar. De qualquer das maneiras, apõs cada voo, o valor do semáforo será sempre 0 e consistente. 
-     	    //printf("planeEmpty\n");
-	    if (semDown (semgid, sh->planeEmpty) == -1)  {                                                 
-		perror ("erro ao bloquear semáforo que faz o piloto esperar pelo último passageiro");
-		exit (EXIT_FAILURE);
-	    }
-	
- 
+	//o piloto só parte quando o semáfoto planeEmpty estiver desbloqueado. Se o último passageiro chegar aqui primeiro, o piloto não espera. De qualquer das maneiras, apõs cada voo, o valor do semáforo será sempre 0 e consistente. A entrada na região crítica é feita na mesma operação
+    SEM_OP empty[2] = {{ sh->planeEmpty, -1 }, { sh->mutex, -1 }};
 
-    if (semDown (semgid, sh->mutex) == -1) {                                                  /* enter critical region */
-        perror ("error on the down operation for semaphore access (PT)");
+    if (semOps (semgid, empty, 2) == -1) {                                                  /* enter critical region */
+        perror ("erro ao bloquear semáforo que faz o piloto esperar pelo último passageiro");
         exit (EXIT_FAILURE);
     }
+    seqWriteBegin (&sh->fStSeq);
 
     /* insert your code here */
     //o piloto muda para o estado 0 (FLYING_BACK). É apresentada a informação de que o avião está a regressar, e o estado não é guardado
@@ -299,6 +336,7 @@ static void dropPassengersAtTarget ()
     saveFlightReturning(nFic, &sh->fSt);
     //saveState(nFic, &sh->fSt);
 
+    seqWriteEnd (&sh->fStSeq);
     if (semUp (semgid, sh->mutex) == -1)  {                                                   /* exit critical region */
         perror ("error on the up operation for semaphore access (PT)");
         exit (EXIT_FAILURE);
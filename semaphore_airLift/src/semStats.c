@@ -0,0 +1,208 @@
+/**
+ *  \file semStats.c (implementation file)
+ *
+ *  \brief Problem name: Air Lift.
+ *
+ *  \brief Instrumentation of the semaphore operations.
+ *
+ *  Only compiled in when <tt>SEM_STATS</tt> is defined. The wrappers call the actual operations with their names
+ *  between parentheses, so that they are not replaced by the macros of <tt>semStats.h</tt>. The statistics area is
+ *  shared by all the processes of the same entity type, so it is updated with atomic operations.
+ */
+
+#ifdef SEM_STATS
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <time.h>
+
+#include "semaphore.h"
+#include "semStats.h"
+
+/** \brief statistics of the entity type of the process, or of the thread in the threaded build (NULL, if it is
+ *         not recorded) */
+static _Thread_local SEM_STAT *myStat = NULL;
+
+/**
+ *  \brief Getting the present time in ns.
+ */
+
+static unsigned long long now (void)
+{
+    struct timespec t;
+
+    clock_gettime (CLOCK_MONOTONIC, &t);
+    return (unsigned long long) t.tv_sec * 1000000000ULL + (unsigned long long) t.tv_nsec;
+}
+
+/**
+ *  \brief Recording a <em>down</em> operation.
+ *
+ *  \param sindex semaphore location in the set
+ *  \param ns time spent (in ns)
+ */
+
+static void recordDown (unsigned int sindex, unsigned long long ns)
+{
+    SEM_STAT *st = &myStat[sindex];
+    unsigned long long max = __atomic_load_n (&st->maxWaitNs, __ATOMIC_RELAXED);
+    unsigned int k = (ns == 0) ? 0 : (unsigned int) (63 - __builtin_clzll (ns));
+
+    __atomic_fetch_add (&st->nDown, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add (&st->waitNs, ns, __ATOMIC_RELAXED);
+    while ((ns > max) &&
+           !__atomic_compare_exchange_n (&st->maxWaitNs, &max, ns, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+        /* max was reloaded by the failed exchange */
+    }
+    __atomic_fetch_add (&st->hist[(k < STATS_HISTSIZE) ? k : STATS_HISTSIZE - 1], 1, __ATOMIC_RELAXED);
+}
+
+/**
+ *  \brief Recording an <em>up</em> operation.
+ *
+ *  \param sindex semaphore location in the set
+ */
+
+static void recordUp (unsigned int sindex)
+{
+    __atomic_fetch_add (&myStat[sindex].nUp, 1, __ATOMIC_RELAXED);
+}
+
+/**
+ *  \brief Recording the semaphore operations of the calling process.
+ *
+ *  \param area pointer to the statistics area
+ *  \param entity entity type of the process
+ */
+
+void semStatsAttach (SEM_STATS_AREA *area, unsigned int entity)
+{
+    myStat = (entity < STATS_NENT) ? area->stat[entity] : NULL;
+}
+
+/**
+ *  \brief Printing the statistics table.
+ *
+ *  \param fp stream the table is printed to
+ *  \param area pointer to the statistics area
+ *  \param names semaphore names, by location in the set
+ *  \param nSem number of names
+ */
+
+void semStatsPrint (FILE *fp, const SEM_STATS_AREA *area, const char *const names[], unsigned int nSem)
+{
+    static const char *const entName[STATS_NENT] = { "pilot", "hostess", "passenger" };
+    unsigned int s, e, k;
+
+    fprintf (fp, "\n%-24s %-10s %9s %9s %12s %11s %11s\n", "Semaphore", "Entity", "Downs", "Ups", "Wait (ms)",
+             "Mean (us)", "Max (us)");
+    for (s = 0; (s < nSem) && (s < STATS_NSEM); s++) {
+        for (e = 0; e < STATS_NENT; e++) {
+            const SEM_STAT *st = &area->stat[e][s];
+
+            if ((st->nDown == 0) && (st->nUp == 0)) {
+                continue;
+            }
+            fprintf (fp, "%-24s %-10s %9lu %9lu %12.3f %11.1f %11.1f\n", names[s], entName[e], st->nDown, st->nUp,
+                     st->waitNs / 1e6, (st->nDown > 0) ? st->waitNs / 1e3 / st->nDown : 0.0, st->maxWaitNs / 1e3);
+            if (st->nDown > 0) {                                          /* classes of the histogram, in ns */
+                fprintf (fp, "%-24s %-10s", "", "");
+                for (k = 0; k < STATS_HISTSIZE; k++) {
+                    if (st->hist[k] > 0) {
+                        fprintf (fp, " 2^%u:%lu", k, st->hist[k]);
+                    }
+                }
+                fprintf (fp, "\n");
+            }
+        }
+    }
+}
+
+/** \brief Instrumented <em>down</em>, timed. */
+
+int semStatsDown (int semgid, unsigned int sindex)
+{
+    unsigned long long t0;
+    int stat;
+
+    if ((myStat == NULL) || (sindex >= STATS_NSEM)) {
+        return (semDown) (semgid, sindex);
+    }
+    t0 = now ();
+    if ((stat = (semDown) (semgid, sindex)) == 0) {
+        recordDown (sindex, now () - t0);
+    }
+    return stat;
+}
+
+/** \brief Instrumented <em>up</em>. */
+
+int semStatsUp (int semgid, unsigned int sindex)
+{
+    int stat;
+
+    if (((stat = (semUp) (semgid, sindex)) == 0) && (myStat != NULL) && (sindex < STATS_NSEM)) {
+        recordUp (sindex);
+    }
+    return stat;
+}
+
+/** \brief Instrumented <em>down</em> by several units, timed. */
+
+int semStatsDownN (int semgid, unsigned int sindex, unsigned int n)
+{
+    unsigned long long t0;
+    int stat;
+
+    if ((myStat == NULL) || (sindex >= STATS_NSEM) || (n == 0)) {
+        return (semDownN) (semgid, sindex, n);
+    }
+    t0 = now ();
+    if ((stat = (semDownN) (semgid, sindex, n)) == 0) {
+        recordDown (sindex, now () - t0);
+    }
+    return stat;
+}
+
+/** \brief Instrumented <em>up</em> by several units. */
+
+int semStatsUpN (int semgid, unsigned int sindex, unsigned int n)
+{
+    int stat;
+
+    if (((stat = (semUpN) (semgid, sindex, n)) == 0) && (myStat != NULL) && (sindex < STATS_NSEM) && (n > 0)) {
+        recordUp (sindex);
+    }
+    return stat;
+}
+
+/** \brief Instrumented operations on several semaphores; the call is timed. */
+
+int semStatsOps (int semgid, const SEM_OP ops[], unsigned int nOps)
+{
+    unsigned long long t0, ns;
+    unsigned int i;
+    int stat;
+
+    if (myStat == NULL) {
+        return (semOps) (semgid, ops, nOps);
+    }
+    t0 = now ();
+    if ((stat = (semOps) (semgid, ops, nOps)) == 0) {
+        ns = now () - t0;                                               /* every down of the call is charged with it */
+        for (i = 0; i < nOps; i++) {
+            if (ops[i].sindex >= STATS_NSEM) {
+                continue;
+            }
+            if (ops[i].delta < 0) {
+                recordDown (ops[i].sindex, ns);
+            }
+            else if (ops[i].delta > 0) {
+                recordUp (ops[i].sindex);
+            }
+        }
+    }
+    return stat;
+}
+
+#endif /* SEM_STATS */
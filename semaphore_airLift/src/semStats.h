@@ -0,0 +1,125 @@
+/**
+ *  \file semStats.h (interface file)
+ *
+ *  \brief Problem name: Air Lift.
+ *
+ *  \brief Instrumentation of the semaphore operations.
+ *
+ *  When compiled with <tt>SEM_STATS</tt> defined, the semaphore operations of the intervening entities are
+ *  replaced by wrappers that record, per semaphore and per entity type, in a statistics area in shared memory:
+ *     \li the number of <em>down</em> and <em>up</em> operations
+ *     \li the time spent in <em>down</em> operations (monotonic clock) and the longest one
+ *     \li a histogram of the <em>down</em> times in powers of 2 of ns.
+ *
+ *  The time of a <tt>semOps</tt> call is charged to every <em>down</em> in it: a passenger that waits for the end
+ *  of the flight and enters the critical region at once shows the same wait on both semaphores.
+ *
+ *  Without <tt>SEM_STATS</tt>, the operations are not replaced and <tt>semStatsAttach</tt> and
+ *  <tt>semStatsPrint</tt> do nothing, their arguments are not even evaluated: the instrumentation has no cost.
+ */
+
+#ifndef SEMSTATS_H_
+#define SEMSTATS_H_
+
+#include <stdio.h>
+
+#include "semaphore.h"
+
+/* Entity types */
+
+/** \brief pilot */
+#define  STATS_PILOT                  0
+/** \brief hostess */
+#define  STATS_HOSTESS                1
+/** \brief passenger */
+#define  STATS_PASSENGER              2
+/** \brief number of entity types */
+#define  STATS_NENT                   3
+
+/** \brief largest number of semaphores in a set that are instrumented, semaphore 0 included */
+#define  STATS_NSEM                  16
+
+/** \brief number of classes of the histogram of down times (the last one holds from 2^31 ns up) */
+#define  STATS_HISTSIZE              32
+
+/**
+ *  \brief Definition of <em>semaphore statistics</em> data type.
+ */
+typedef struct
+        { /** \brief number of <em>down</em> operations */
+          unsigned long nDown;
+          /** \brief number of <em>up</em> operations */
+          unsigned long nUp;
+          /** \brief time spent in <em>down</em> operations (in ns) */
+          unsigned long long waitNs;
+          /** \brief longest <em>down</em> operation (in ns) */
+          unsigned long long maxWaitNs;
+          /** \brief number of <em>down</em> operations that took from 2^k up to 2^(k+1) ns, class k */
+          unsigned long hist[STATS_HISTSIZE];
+
+        } SEM_STAT;
+
+/**
+ *  \brief Definition of <em>statistics area</em> data type (in shared memory, all 0 upon creation).
+ */
+typedef struct
+        { /** \brief statistics per entity type and semaphore */
+          SEM_STAT stat[STATS_NENT][STATS_NSEM];
+
+        } SEM_STATS_AREA;
+
+#ifdef SEM_STATS
+
+/**
+ *  \brief Recording the semaphore operations of the calling process.
+ *
+ *  \param area pointer to the statistics area
+ *  \param entity entity type of the process (<tt>STATS_PILOT</tt>, <tt>STATS_HOSTESS</tt> or
+ *         <tt>STATS_PASSENGER</tt>)
+ */
+
+extern void semStatsAttach (SEM_STATS_AREA *area, unsigned int entity);
+
+/**
+ *  \brief Printing the statistics table.
+ *
+ *  A line is printed for every semaphore and entity type with recorded operations, followed by the non-empty
+ *  classes of its histogram.
+ *
+ *  \param fp stream the table is printed to
+ *  \param area pointer to the statistics area
+ *  \param names semaphore names, by location in the set
+ *  \param nSem number of names
+ */
+
+extern void semStatsPrint (FILE *fp, const SEM_STATS_AREA *area, const char *const names[], unsigned int nSem);
+
+/** \brief instrumented <em>down</em> (see <tt>semDown</tt>) */
+extern int semStatsDown (int semgid, unsigned int sindex);
+
+/** \brief instrumented <em>up</em> (see <tt>semUp</tt>) */
+extern int semStatsUp (int semgid, unsigned int sindex);
+
+/** \brief instrumented <em>down</em> by several units (see <tt>semDownN</tt>) */
+extern int semStatsDownN (int semgid, unsigned int sindex, unsigned int n);
+
+/** \brief instrumented <em>up</em> by several units (see <tt>semUpN</tt>) */
+extern int semStatsUpN (int semgid, unsigned int sindex, unsigned int n);
+
+/** \brief instrumented operations on several semaphores (see <tt>semOps</tt>) */
+extern int semStatsOps (int semgid, const SEM_OP ops[], unsigned int nOps);
+
+#define  semDown(semgid, sindex)           semStatsDown ((semgid), (sindex))
+#define  semUp(semgid, sindex)             semStatsUp ((semgid), (sindex))
+#define  semDownN(semgid, sindex, n)       semStatsDownN ((semgid), (sindex), (n))
+#define  semUpN(semgid, sindex, n)         semStatsUpN ((semgid), (sindex), (n))
+#define  semOps(semgid, ops, nOps)         semStatsOps ((semgid), (ops), (nOps))
+
+#else
+
+#define  semStatsAttach(area, entity)               ((void) 0)
+#define  semStatsPrint(fp, area, names, nSem)       ((void) 0)
+
+#endif /* SEM_STATS */
+
+#endif /* SEMSTATS_H_ */
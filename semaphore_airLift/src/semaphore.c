@@ -3,25 +3,48 @@
  *
  *  \brief Semaphore management.
  *
+ *  Implementation based on SVIPC semaphore sets (the default; see <tt>semaphoreFutex.c</tt>,
+ *  <tt>semaphorePosix.c</tt> and <tt>semaphoreCoro.c</tt> for the ones built with <tt>SEM_FUTEX</tt>,
+ *  <tt>SEM_POSIX</tt> or <tt>SEM_CORO</tt> defined).
+ *
  *  Operations defined on semaphores:
  *     \li creation of a set of semaphores
  *     \li connection to a previously created set of semaphores
  *     \li destruction of a previously created set of semaphores
+ *     \li destruction of a set of semaphores left behind, given its creation key
  *     \li signalling start of operations
  *     \li <em>down</em> of a semaphore within the set
- *     \li <em>up</em> of a semaphore within the set.
+ *     \li <em>up</em> of a semaphore within the set
+ *     \li <em>down</em> and <em>up</em> of a semaphore within the set by several units at once
+ *     \li <em>down</em> and <em>up</em> of several semaphores within the set at once
+ *     \li setting the spin limit of a semaphore (no effect) and getting its counters
+ *     \li <em>down</em> of a semaphore within the set with a time limit
+ *     \li getting the value of a semaphore within the set.
+ *
+ *  When built with <tt>SEM_SPLIT</tt> defined, the operations of <tt>semOps</tt> are carried out one system call
+ *  each, as they were before it was introduced (see <tt>semCount.sh</tt>).
  *
  *  \author António Rui Borges - October 1995
  */
 
+#if !defined (SEM_FUTEX) && !defined (SEM_POSIX) && !defined (SEM_CORO)
+
+#define _GNU_SOURCE                                                                               /* for semtimedop */
+
 #include <stdio.h>
+#include <errno.h>
 #include <sys/types.h>
 #include <sys/ipc.h>
 #include <sys/sem.h>
 
+#include "semaphore.h"
+
 /** \brief access permission: user r-w */
 #define  MASK           0600
 
+/** \brief largest number of units of a single operation (the value of <tt>sem_op</tt> is a short) */
+#define  MAXOP          32767
+
 /**
  *  \brief Creation of a set of semaphores.
  *
@@ -79,6 +102,27 @@ int semDestroy (int semgid)
   return semctl (semgid, 0, IPC_RMID, NULL);
 }
 
+/**
+ *  \brief Destruction of a set of semaphores left behind, given its creation key.
+ *
+ *  The processes blocked on the set are woken up with <tt>EIDRM</tt>.
+ *  The function fails if there is no semaphore set with a creation key equal to <tt>key</tt>.
+ *
+ *  \param key creation key
+ *
+ *  \return \c 0, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+int semReclaim (int key)
+{
+  int semgid;                                                                            /* semaphore set identifier */
+
+  if ((semgid = semget ((key_t) key, 0, MASK)) == -1)
+     return -1;
+  return semctl (semgid, 0, IPC_RMID, NULL);
+}
+
 /**
  *  \brief Signalling start of operations upon initialization of shared data structures.
  *
@@ -136,3 +180,198 @@ int semUp (int semgid, unsigned int sindex)
   up.sem_num = (unsigned short) sindex;
   return semop (semgid, &up, 1);
 }
+
+/**
+ *  \brief <em>Down</em> of a semaphore within the set by <tt>n</tt> units.
+ *
+ *  A single <tt>semop</tt> system call with <tt>sem_op</tt> = -<tt>n</tt> is carried out.
+ *  The function fails if there is no semaphore set with an identifier equal to <tt>semgid</tt>.
+ *
+ *  \param semgid set identifier
+ *  \param sindex semaphore location in the set (1 .. snum)
+ *  \param n number of units
+ *
+ *  \return \c 0, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+int semDownN (int semgid, unsigned int sindex, unsigned int n)
+{
+  struct sembuf down = { 0, 0, 0 };                                                       /* specific down operation */
+
+  if (n == 0)
+     return 0;                                                                 /* sem_op = 0 would wait for zero */
+  if (n > MAXOP)
+     { errno = EINVAL;
+       return -1;
+     }
+  down.sem_num = (unsigned short) sindex;
+  down.sem_op = (short) -n;
+  return semop (semgid, &down, 1);
+}
+
+/**
+ *  \brief <em>Up</em> of a semaphore within the set by <tt>n</tt> units.
+ *
+ *  A single <tt>semop</tt> system call with <tt>sem_op</tt> = <tt>n</tt> is carried out.
+ *  The function fails if there is no semaphore set with an identifier equal to <tt>semgid</tt>.
+ *
+ *  \param semgid set identifier
+ *  \param sindex semaphore location in the set (1 .. snum)
+ *  \param n number of units
+ *
+ *  \return \c 0, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+int semUpN (int semgid, unsigned int sindex, unsigned int n)
+{
+  struct sembuf up = { 0, 0, 0 };                                                           /* specific up operation */
+
+  if (n == 0)
+     return 0;                                                                 /* sem_op = 0 would wait for zero */
+  if (n > MAXOP)
+     { errno = EINVAL;
+       return -1;
+     }
+  up.sem_num = (unsigned short) sindex;
+  up.sem_op = (short) n;
+  return semop (semgid, &up, 1);
+}
+
+/**
+ *  \brief <em>Down</em> and <em>up</em> of several semaphores within the set at once.
+ *
+ *  A single <tt>semop</tt> system call with an array of operations is carried out, so they are applied atomically
+ *  (unless <tt>SEM_SPLIT</tt> is defined).
+ *  The function fails if there is no semaphore set with an identifier equal to <tt>semgid</tt>, or if
+ *  <tt>nOps</tt> is larger than <tt>SEMOPSMAX</tt>.
+ *
+ *  \param semgid set identifier
+ *  \param ops operations
+ *  \param nOps number of operations
+ *
+ *  \return \c 0, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+int semOps (int semgid, const SEM_OP ops[], unsigned int nOps)
+{
+  struct sembuf op[SEMOPSMAX];                                                                /* specific operations */
+  unsigned int i, n;
+
+  if (nOps > SEMOPSMAX)
+     { errno = E2BIG;
+       return -1;
+     }
+  for (i = 0, n = 0; i < nOps; i++)
+    { if (ops[i].delta == 0)
+         continue;                                                             /* sem_op = 0 would wait for zero */
+      if ((ops[i].delta > MAXOP) || (ops[i].delta < -MAXOP))
+         { errno = EINVAL;
+           return -1;
+         }
+      op[n].sem_num = (unsigned short) ops[i].sindex;
+      op[n].sem_op = (short) ops[i].delta;
+      op[n].sem_flg = 0;
+      n += 1;
+    }
+  if (n == 0)
+     return 0;
+#ifdef SEM_SPLIT
+  for (i = 0; i < n; i++)
+    if (semop (semgid, &op[i], 1) == -1)
+       return -1;
+  return 0;
+#else
+  return semop (semgid, op, n);
+#endif
+}
+
+/**
+ *  \brief Setting the spin limit of a semaphore within the set.
+ *
+ *  Every operation on a SVIPC semaphore is a system call, so there is nothing to spin on in user space: the limit
+ *  is accepted and has no effect.
+ *  The function fails if there is no semaphore set with an identifier equal to <tt>semgid</tt>.
+ *
+ *  \param semgid set identifier
+ *  \param sindex semaphore location in the set (1 .. snum)
+ *  \param limit largest number of retries
+ *
+ *  \return \c 0, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+int semSetSpin (int semgid, unsigned int sindex, unsigned int limit)
+{
+  (void) limit;
+  return (semctl (semgid, (int) sindex, GETVAL) == -1) ? -1 : 0;
+}
+
+/**
+ *  \brief Getting the spin counters of a semaphore within the set.
+ *
+ *  They are always 0.
+ *  The function fails if there is no semaphore set with an identifier equal to <tt>semgid</tt>.
+ *
+ *  \param semgid set identifier
+ *  \param sindex semaphore location in the set (1 .. snum)
+ *  \param stats pointer to the location where the counters are stored
+ *
+ *  \return \c 0, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+int semSpinStats (int semgid, unsigned int sindex, SEM_SPIN_STATS *stats)
+{
+  if (semctl (semgid, (int) sindex, GETVAL) == -1)
+     return -1;
+  stats->nSpinAcquired = 0;
+  stats->nBlocked = 0;
+  return 0;
+}
+
+/**
+ *  \brief <em>Down</em> of a semaphore within the set with a time limit.
+ *
+ *  A single <tt>semtimedop</tt> system call is carried out; it fails with <tt>EAGAIN</tt> upon timeout.
+ *  The function fails if there is no semaphore set with an identifier equal to <tt>semgid</tt>.
+ *
+ *  \param semgid set identifier
+ *  \param sindex semaphore location in the set (1 .. snum)
+ *  \param timeout time limit (in ms)
+ *
+ *  \return \c 0, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+int semDownTimed (int semgid, unsigned int sindex, unsigned int timeout)
+{
+  struct sembuf down = { 0, -1, 0 };                                                      /* specific down operation */
+  struct timespec t;
+
+  down.sem_num = (unsigned short) sindex;
+  t.tv_sec = timeout / 1000;
+  t.tv_nsec = (long) (timeout % 1000) * 1000000L;
+  return semtimedop (semgid, &down, 1, &t);
+}
+
+/**
+ *  \brief Getting the value of a semaphore within the set.
+ *
+ *  The function fails if there is no semaphore set with an identifier equal to <tt>semgid</tt>.
+ *
+ *  \param semgid set identifier
+ *  \param sindex semaphore location in the set (0 .. snum)
+ *
+ *  \return value of the semaphore, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+int semGetValue (int semgid, unsigned int sindex)
+{
+  return semctl (semgid, (int) sindex, GETVAL);
+}
+
+#endif /* !SEM_FUTEX && !SEM_POSIX && !SEM_CORO */
@@ -7,9 +7,15 @@
  *     \li creation of a set of semaphores
  *     \li connection to a previously created set of semaphores
  *     \li destruction of a previously created set of semaphores
+ *     \li destruction of a set of semaphores left behind, given its creation key
  *     \li signalling start of operations
  *     \li <em>down</em> of a semaphore within the set
- *     \li <em>up</em> of a semaphore within the set.
+ *     \li <em>up</em> of a semaphore within the set
+ *     \li <em>down</em> and <em>up</em> of a semaphore within the set by several units at once
+ *     \li <em>down</em> and <em>up</em> of several semaphores within the set at once
+ *     \li setting how long a <em>down</em> of a semaphore spins before blocking, and getting its counters
+ *     \li <em>down</em> of a semaphore within the set with a time limit
+ *     \li getting the value of a semaphore within the set.
  *
  *  \author António Rui Borges - October 1995
  */
@@ -17,6 +23,67 @@
 #ifndef SEMAPHORE_H_
 #define SEMAPHORE_H_
 
+/**
+ *  \brief Definition of <em>spin counters</em> data type (see <tt>semSetSpin</tt>).
+ */
+typedef struct
+        { /** \brief number of <em>down</em> operations that succeeded while spinning */
+          unsigned long nSpinAcquired;
+          /** \brief number of times a process blocked after spinning */
+          unsigned long nBlocked;
+
+        } SEM_SPIN_STATS;
+
+#ifdef SEM_POSIX
+
+#include <stdbool.h>
+#include <pthread.h>
+#include <semaphore.h>
+
+/** \brief maximum number of semaphores in a set, semaphore 0 included (POSIX build) */
+#define  SEMPOSIXMAX   16
+
+/**
+ *  \brief Definition of <em>set of POSIX semaphores</em> data type.
+ *
+ *  In the POSIX build (<tt>SEM_POSIX</tt> defined), the semaphores are process-shared <tt>sem_t</tt> objects kept
+ *  at the start of the shared memory block with the same creation key, which must be created first. The start of
+ *  operations is signalled through a gate made of a process-shared mutex and condition variable.
+ */
+typedef struct
+        { /** \brief lock of the start gate */
+          pthread_mutex_t lock;
+          /** \brief condition signalled when the start gate opens */
+          pthread_cond_t open;
+          /** \brief the start of operations was signalled */
+          bool started;
+          /** \brief number of semaphores in the set, semaphore 0 included */
+          unsigned int snum;
+          /** \brief semaphores */
+          sem_t sem[SEMPOSIXMAX];
+          /** \brief spin limit of every semaphore (see <tt>semSetSpin</tt>) */
+          unsigned int spinLimit[SEMPOSIXMAX];
+          /** \brief spin counters of every semaphore */
+          SEM_SPIN_STATS spinStats[SEMPOSIXMAX];
+
+        } SEM_SET;
+
+#endif /* SEM_POSIX */
+
+/** \brief maximum number of operations carried out at once by <tt>semOps</tt> */
+#define  SEMOPSMAX     8
+
+/**
+ *  \brief Definition of <em>semaphore operation</em> data type (see <tt>semOps</tt>).
+ */
+typedef struct
+        { /** \brief semaphore location in the set (1 .. snum) */
+          unsigned int sindex;
+          /** \brief number of units: <em>up</em>, if positive, <em>down</em>, if negative (0 is ignored) */
+          int delta;
+
+        } SEM_OP;
+
 /**
  *  \brief Creation of a set of semaphores.
  *
@@ -58,6 +125,22 @@ extern int semConnect (int key);
 
 extern int semDestroy (int semgid);
 
+/**
+ *  \brief Destruction of a set of semaphores left behind, given its creation key.
+ *
+ *  The set is destroyed without connecting to it, so that a set whose start of operations was never signalled is
+ *  destroyed as well (see <tt>ipcRegistry.h</tt>). The processes still blocked on it, if any, are not woken up
+ *  in every implementation.
+ *  The function fails if there is no semaphore set with a creation key equal to <tt>key</tt>.
+ *
+ *  \param key creation key
+ *
+ *  \return \c 0, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+extern int semReclaim (int key);
+
 /**
  *  \brief Signalling start of operations upon initialization of shared data structures.
  *
@@ -99,4 +182,125 @@ extern int semDown (int semgid, unsigned int sindex);
 
 extern int semUp (int semgid, unsigned int sindex);
 
+/**
+ *  \brief <em>Down</em> of a semaphore within the set by <tt>n</tt> units.
+ *
+ *  Same as <tt>n</tt> <em>down</em> operations, carried out at once (in the POSIX build, one after the other).
+ *  The function fails if there is no semaphore set with an identifier equal to <tt>semgid</tt>.
+ *
+ *  \param semgid set identifier
+ *  \param sindex semaphore location in the set (1 .. snum)
+ *  \param n number of units
+ *
+ *  \return \c 0, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+extern int semDownN (int semgid, unsigned int sindex, unsigned int n);
+
+/**
+ *  \brief <em>Up</em> of a semaphore within the set by <tt>n</tt> units.
+ *
+ *  Same as <tt>n</tt> <em>up</em> operations, carried out at once (in the SVIPC build, with a single system call).
+ *  The function fails if there is no semaphore set with an identifier equal to <tt>semgid</tt>.
+ *
+ *  \param semgid set identifier
+ *  \param sindex semaphore location in the set (1 .. snum)
+ *  \param n number of units
+ *
+ *  \return \c 0, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+extern int semUpN (int semgid, unsigned int sindex, unsigned int n);
+
+/**
+ *  \brief <em>Down</em> and <em>up</em> of several semaphores within the set at once.
+ *
+ *  In the SVIPC build, the operations are carried out atomically with a single system call: the process is blocked
+ *  until all the <em>down</em> operations can be carried out, and none of them is applied meanwhile. So, the exit
+ *  of a critical region must not be joined to a <em>down</em> that may block: the region would stay locked.
+ *  In the futex and POSIX builds, the operations are carried out one after the other, in the given order.
+ *  The function fails if there is no semaphore set with an identifier equal to <tt>semgid</tt>, or if
+ *  <tt>nOps</tt> is larger than <tt>SEMOPSMAX</tt>.
+ *
+ *  \param semgid set identifier
+ *  \param ops operations
+ *  \param nOps number of operations
+ *
+ *  \return \c 0, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+extern int semOps (int semgid, const SEM_OP ops[], unsigned int nOps);
+
+/**
+ *  \brief Setting the spin limit of a semaphore within the set.
+ *
+ *  A <em>down</em> operation that cannot be carried out at once retries it up to <tt>limit</tt> times, waiting
+ *  between retries with CPU pause instructions in growing numbers (bounded backoff), and only then blocks. It pays
+ *  off for semaphores held for a short time, like the one of a short critical region, on a multiprocessor.
+ *  The limit is 0 (block at once) upon creation. In the SVIPC build, where every operation enters the kernel,
+ *  the limit has no effect.
+ *  The function fails if there is no semaphore set with an identifier equal to <tt>semgid</tt>.
+ *
+ *  \param semgid set identifier
+ *  \param sindex semaphore location in the set (1 .. snum)
+ *  \param limit largest number of retries
+ *
+ *  \return \c 0, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+extern int semSetSpin (int semgid, unsigned int sindex, unsigned int limit);
+
+/**
+ *  \brief Getting the spin counters of a semaphore within the set.
+ *
+ *  The counters are shared by all processes and are only updated while the spin limit is not 0 (they are always
+ *  0 in the SVIPC build).
+ *  The function fails if there is no semaphore set with an identifier equal to <tt>semgid</tt>.
+ *
+ *  \param semgid set identifier
+ *  \param sindex semaphore location in the set (1 .. snum)
+ *  \param stats pointer to the location where the counters are stored
+ *
+ *  \return \c 0, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+extern int semSpinStats (int semgid, unsigned int sindex, SEM_SPIN_STATS *stats);
+
+/**
+ *  \brief <em>Down</em> of a semaphore within the set with a time limit.
+ *
+ *  Same as <em>down</em>, but the function fails with <tt>errno</tt> set to <tt>EAGAIN</tt> if the operation could
+ *  not be carried out within <tt>timeout</tt> ms.
+ *  The function fails if there is no semaphore set with an identifier equal to <tt>semgid</tt>.
+ *
+ *  \param semgid set identifier
+ *  \param sindex semaphore location in the set (1 .. snum)
+ *  \param timeout time limit (in ms)
+ *
+ *  \return \c 0, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+extern int semDownTimed (int semgid, unsigned int sindex, unsigned int timeout);
+
+/**
+ *  \brief Getting the value of a semaphore within the set.
+ *
+ *  The value may have changed by the time it is returned: it is meant for diagnostics.
+ *  The function fails if there is no semaphore set with an identifier equal to <tt>semgid</tt>.
+ *
+ *  \param semgid set identifier
+ *  \param sindex semaphore location in the set (0 .. snum)
+ *
+ *  \return value of the semaphore, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+extern int semGetValue (int semgid, unsigned int sindex);
+
 #endif /* SEMAPHORE_H_ */
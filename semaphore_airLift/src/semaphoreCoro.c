@@ -0,0 +1,509 @@
+/**
+ *  \file semaphoreCoro.c (implementation file)
+ *
+ *  \brief Semaphore management.
+ *
+ *  Implementation based on queues of coroutines (build with <tt>SEM_CORO</tt> defined, together with
+ *  <tt>THREADED</tt>; see <tt>semaphore.c</tt> for the SVIPC one and <tt>coroutine.h</tt>).
+ *
+ *  The intervening entities are coroutines run by a single thread of the generator, so the semaphores are plain
+ *  counters in the memory of the process: a <em>down</em> on a semaphore whose value is 0 suspends the running
+ *  coroutine at the end of the queue of the semaphore, and an <em>up</em> hands the unit over to the first coroutine
+ *  of the queue, if any, instead of incrementing the value. No system call is made and the queue is served in
+ *  order. The generator may create the set, signal the start of operations and get the values from other threads;
+ *  a <em>down</em> that would block out of a coroutine fails with <tt>EDEADLK</tt>.
+ *
+ *  Semaphore 0 of the set is reserved for the signalling of the start of operations, as in the SVIPC
+ *  implementation, so the semaphores are located at 1 .. snum.
+ *
+ *  Operations defined on semaphores:
+ *     \li creation of a set of semaphores
+ *     \li connection to a previously created set of semaphores
+ *     \li destruction of a previously created set of semaphores
+ *     \li destruction of a set of semaphores left behind, given its creation key
+ *     \li signalling start of operations
+ *     \li <em>down</em> of a semaphore within the set
+ *     \li <em>up</em> of a semaphore within the set
+ *     \li <em>down</em> and <em>up</em> of a semaphore within the set by several units, one after the other
+ *     \li <em>down</em> and <em>up</em> of several semaphores within the set, one after the other
+ *     \li setting the spin limit of a semaphore (no effect) and getting its counters
+ *     \li <em>down</em> of a semaphore within the set with a time limit
+ *     \li getting the value of a semaphore within the set.
+ */
+
+#ifdef SEM_CORO
+
+#ifndef THREADED
+#error "the coroutine semaphores are only shared by the entities of the threaded build"
+#endif
+
+#if defined (SEM_FUTEX) || defined (SEM_POSIX)
+#error "only one semaphore implementation may be chosen"
+#endif
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+
+#include "semaphore.h"
+#include "coroutine.h"
+
+/** \brief maximum number of sets */
+#define  SEMTABSIZE     8
+
+/** \brief maximum number of semaphores in a set, semaphore 0 included */
+#define  SEMCOROMAX    16
+
+/** \brief period of the retries of a <em>down</em> with a time limit (in us) */
+#define  TIMEDPOLL    1000
+
+/**
+ *  \brief Definition of <em>semaphore</em> data type.
+ */
+typedef struct
+{ /** \brief semaphore value (0, while a coroutine is waiting) */
+    unsigned int val;
+    /** \brief coroutines waiting for a unit */
+    CO_QUEUE waiting;
+    /** \brief largest number of retries of a <em>down</em> before blocking (no effect) */
+    unsigned int spinLimit;
+
+} CORO_SEM;
+
+/**
+ *  \brief Definition of <em>set of semaphores</em> data type.
+ */
+typedef struct
+{ /** \brief the entry is in use */
+    bool used;
+    /** \brief creation key */
+    int key;
+    /** \brief number of semaphores in the set, semaphore 0 included */
+    unsigned int snum;
+    /** \brief semaphores */
+    CORO_SEM sem[SEMCOROMAX];
+
+} CORO_SET;
+
+/** \brief sets of the process; the set identifier is the location in the table */
+static CORO_SET semTab[SEMTABSIZE];
+
+/**
+ *  \brief Getting a semaphore within a set.
+ *
+ *  \param semgid set identifier
+ *  \param sindex semaphore location in the set
+ *
+ *  \return pointer to the semaphore, upon success
+ *  \return NULL, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+static CORO_SEM *semGet (int semgid, unsigned int sindex)
+{
+  if ((semgid < 0) || (semgid >= SEMTABSIZE) || !semTab[semgid].used || (sindex >= semTab[semgid].snum))
+     { errno = EINVAL;
+       return NULL;
+     }
+  return &semTab[semgid].sem[sindex];
+}
+
+/**
+ *  \brief <em>Down</em> of a semaphore.
+ *
+ *  The value is decremented if it is positive; otherwise the running coroutine waits at the end of the queue until
+ *  an <em>up</em> hands a unit over to it.
+ *
+ *  \param s pointer to the semaphore
+ *
+ *  \return \c 0, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+static int coroDown (CORO_SEM *s)
+{
+  unsigned int v = __atomic_load_n (&s->val, __ATOMIC_RELAXED);
+
+  if (v > 0)
+     { __atomic_store_n (&s->val, v - 1, __ATOMIC_RELAXED);                                            /* fast path */
+       return 0;
+     }
+  if (!coInside ())
+     { errno = EDEADLK;
+       return -1;
+     }
+  coWait (&s->waiting);
+  return 0;
+}
+
+/**
+ *  \brief <em>Up</em> of a semaphore by <tt>n</tt> units.
+ *
+ *  A unit is handed over to every waiting coroutine, up to <tt>n</tt>, in the order they are waiting; the value is
+ *  incremented by the rest.
+ *
+ *  \param s pointer to the semaphore
+ *  \param n number of units
+ */
+
+static void coroUp (CORO_SEM *s, unsigned int n)
+{
+  for (; (n > 0) && coWake (&s->waiting); n--)
+    ;
+  if (n > 0)
+     __atomic_store_n (&s->val, __atomic_load_n (&s->val, __ATOMIC_RELAXED) + n, __ATOMIC_RELAXED);
+}
+
+/**
+ *  \brief Creation of a set of semaphores.
+ *
+ *  All semaphores in the set will be in set to <em>red state</em> upon creation.
+ *  The function fails if there is already a semaphore set with a creation key equal to <tt>key</tt>.
+ *
+ *  \param key creation key
+ *  \param snum number of semaphores in the set (>= 1)
+ *
+ *  \return set identifier, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+int semCreate (int key, unsigned int snum)
+{
+  int semgid, free = -1;
+
+  if ((snum == 0) || (snum >= SEMCOROMAX))
+     { errno = EINVAL;
+       return -1;
+     }
+  for (semgid = 0; semgid < SEMTABSIZE; semgid++)
+    if (!semTab[semgid].used)
+       { if (free == -1)
+            free = semgid;
+       }
+       else if (semTab[semgid].key == key)
+               { errno = EEXIST;
+                 return -1;
+               }
+  if (free == -1)
+     { errno = EMFILE;
+       return -1;
+     }
+  memset (&semTab[free], 0, sizeof (CORO_SET));                               /* the values are 0: all in red state */
+  semTab[free].key = key;
+  semTab[free].snum = snum + 1;
+  semTab[free].used = true;
+  return free;
+}
+
+/**
+ *  \brief Connection to a previously created set of semaphores.
+ *
+ *  The function fails if there is no semaphore set with a creation key equal to <tt>key</tt>.
+ *  The coroutines start together when the scheduler runs them, so no wait for the start of operations is needed.
+ *
+ *  \param key creation key
+ *
+ *  \return set identifier, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+int semConnect (int key)
+{
+  int semgid;
+
+  for (semgid = 0; semgid < SEMTABSIZE; semgid++)
+    if (semTab[semgid].used && (semTab[semgid].key == key))
+       return semgid;
+  errno = ENOENT;
+  return -1;
+}
+
+/**
+ *  \brief Destruction of a previously created set of semaphores.
+ *
+ *  The coroutines still waiting on the set are left waiting.
+ *  The function fails if there is no semaphore set with an identifier equal to <tt>semgid</tt>.
+ *
+ *  \param semgid set identifier
+ *
+ *  \return \c 0, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+int semDestroy (int semgid)
+{
+  if (semGet (semgid, 0) == NULL)
+     return -1;
+  semTab[semgid].used = false;
+  return 0;
+}
+
+/**
+ *  \brief Destruction of a set of semaphores left behind, given its creation key.
+ *
+ *  The sets live in the memory of the process and go with it, so there is nothing to destroy: the function always
+ *  succeeds.
+ *
+ *  \param key creation key
+ *
+ *  \return \c 0
+ */
+
+int semReclaim (int key)
+{
+  return 0;
+}
+
+/**
+ *  \brief Signalling start of operations upon initialization of shared data structures.
+ *
+ *  The function fails if there is no semaphore set with an identifier equal to <tt>semgid</tt>.
+ *
+ *  \param semgid set identifier
+ *
+ *  \return \c 0, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+int semSignal (int semgid)
+{
+  CORO_SEM *s;
+
+  if ((s = semGet (semgid, 0)) == NULL)
+     return -1;
+  coroUp (s, 1);
+  return 0;
+}
+
+/**
+ *  \brief <em>Down</em> of a semaphore within the set.
+ *
+ *  The function fails if there is no semaphore set with an identifier equal to <tt>semgid</tt>.
+ *
+ *  \param semgid set identifier
+ *  \param sindex semaphore location in the set (1 .. snum)
+ *
+ *  \return \c 0, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+int semDown (int semgid, unsigned int sindex)
+{
+  CORO_SEM *s;
+
+  if ((s = semGet (semgid, sindex)) == NULL)
+     return -1;
+  return coroDown (s);
+}
+
+/**
+ *  \brief <em>Up</em> of a semaphore within the set.
+ *
+ *  The function fails if there is no semaphore set with an identifier equal to <tt>semgid</tt>.
+ *
+ *  \param semgid set identifier
+ *  \param sindex semaphore location in the set (1 .. snum)
+ *
+ *  \return \c 0, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+int semUp (int semgid, unsigned int sindex)
+{
+  CORO_SEM *s;
+
+  if ((s = semGet (semgid, sindex)) == NULL)
+     return -1;
+  coroUp (s, 1);
+  return 0;
+}
+
+/**
+ *  \brief <em>Down</em> of a semaphore within the set by <tt>n</tt> units.
+ *
+ *  The units are taken one after the other, each one in turn with the other waiting coroutines.
+ *  The function fails if there is no semaphore set with an identifier equal to <tt>semgid</tt>.
+ *
+ *  \param semgid set identifier
+ *  \param sindex semaphore location in the set (1 .. snum)
+ *  \param n number of units
+ *
+ *  \return \c 0, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+int semDownN (int semgid, unsigned int sindex, unsigned int n)
+{
+  CORO_SEM *s;
+
+  if ((s = semGet (semgid, sindex)) == NULL)
+     return -1;
+  for (; n > 0; n--)
+    if (coroDown (s) == -1)
+       return -1;
+  return 0;
+}
+
+/**
+ *  \brief <em>Up</em> of a semaphore within the set by <tt>n</tt> units.
+ *
+ *  The function fails if there is no semaphore set with an identifier equal to <tt>semgid</tt>.
+ *
+ *  \param semgid set identifier
+ *  \param sindex semaphore location in the set (1 .. snum)
+ *  \param n number of units
+ *
+ *  \return \c 0, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+int semUpN (int semgid, unsigned int sindex, unsigned int n)
+{
+  CORO_SEM *s;
+
+  if ((s = semGet (semgid, sindex)) == NULL)
+     return -1;
+  coroUp (s, n);
+  return 0;
+}
+
+/**
+ *  \brief <em>Down</em> and <em>up</em> of several semaphores within the set at once.
+ *
+ *  The operations are carried out one after the other, in the given order, as in the futex build; no other
+ *  coroutine runs in between unless one of them waits.
+ *  The function fails if there is no semaphore set with an identifier equal to <tt>semgid</tt>, or if
+ *  <tt>nOps</tt> is larger than <tt>SEMOPSMAX</tt>.
+ *
+ *  \param semgid set identifier
+ *  \param ops operations
+ *  \param nOps number of operations
+ *
+ *  \return \c 0, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+int semOps (int semgid, const SEM_OP ops[], unsigned int nOps)
+{
+  unsigned int i;
+  int stat = 0;
+
+  if (nOps > SEMOPSMAX)
+     { errno = E2BIG;
+       return -1;
+     }
+  for (i = 0; (i < nOps) && (stat == 0); i++)
+    if (ops[i].delta > 0)
+       stat = semUpN (semgid, ops[i].sindex, (unsigned int) ops[i].delta);
+       else if (ops[i].delta < 0)
+               stat = semDownN (semgid, ops[i].sindex, (unsigned int) -ops[i].delta);
+  return stat;
+}
+
+/**
+ *  \brief Setting the spin limit of a semaphore within the set.
+ *
+ *  A coroutine never spins: the limit is only kept.
+ *  The function fails if there is no semaphore set with an identifier equal to <tt>semgid</tt>.
+ *
+ *  \param semgid set identifier
+ *  \param sindex semaphore location in the set (1 .. snum)
+ *  \param limit largest number of retries
+ *
+ *  \return \c 0, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+int semSetSpin (int semgid, unsigned int sindex, unsigned int limit)
+{
+  CORO_SEM *s;
+
+  if ((s = semGet (semgid, sindex)) == NULL)
+     return -1;
+  s->spinLimit = limit;
+  return 0;
+}
+
+/**
+ *  \brief Getting the spin counters of a semaphore within the set.
+ *
+ *  The counters are always 0.
+ *  The function fails if there is no semaphore set with an identifier equal to <tt>semgid</tt>.
+ *
+ *  \param semgid set identifier
+ *  \param sindex semaphore location in the set (1 .. snum)
+ *  \param stats pointer to the location where the counters are stored
+ *
+ *  \return \c 0, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+int semSpinStats (int semgid, unsigned int sindex, SEM_SPIN_STATS *stats)
+{
+  if (semGet (semgid, sindex) == NULL)
+     return -1;
+  stats->nSpinAcquired = 0;
+  stats->nBlocked = 0;
+  return 0;
+}
+
+/**
+ *  \brief <em>Down</em> of a semaphore within the set with a time limit.
+ *
+ *  The value is polled every <tt>TIMEDPOLL</tt> us, sleeping in between, so the queue is bypassed.
+ *  The function fails with <tt>EAGAIN</tt> upon timeout, or if there is no semaphore set with an identifier equal
+ *  to <tt>semgid</tt>.
+ *
+ *  \param semgid set identifier
+ *  \param sindex semaphore location in the set (1 .. snum)
+ *  \param timeout time limit (in ms)
+ *
+ *  \return \c 0, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+int semDownTimed (int semgid, unsigned int sindex, unsigned int timeout)
+{
+  CORO_SEM *s;
+  unsigned long long left = (unsigned long long) timeout * 1000ULL;                     /* time left (in us) */
+  unsigned int v;
+
+  if ((s = semGet (semgid, sindex)) == NULL)
+     return -1;
+  for (;;)
+  { if ((v = __atomic_load_n (&s->val, __ATOMIC_RELAXED)) > 0)
+       { __atomic_store_n (&s->val, v - 1, __ATOMIC_RELAXED);
+         return 0;
+       }
+    if (left == 0)
+       { errno = EAGAIN;
+         return -1;
+       }
+    if (coSleep ((left < TIMEDPOLL) ? (unsigned int) left : TIMEDPOLL) == -1)
+       return -1;
+    left = (left < TIMEDPOLL) ? 0 : left - TIMEDPOLL;
+  }
+}
+
+/**
+ *  \brief Getting the value of a semaphore within the set.
+ *
+ *  The function fails if there is no semaphore set with an identifier equal to <tt>semgid</tt>.
+ *
+ *  \param semgid set identifier
+ *  \param sindex semaphore location in the set (0 .. snum)
+ *
+ *  \return value of the semaphore, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+int semGetValue (int semgid, unsigned int sindex)
+{
+  CORO_SEM *s;
+
+  if ((s = semGet (semgid, sindex)) == NULL)
+     return -1;
+  return (int) __atomic_load_n (&s->val, __ATOMIC_RELAXED);
+}
+
+#endif /* SEM_CORO */
@@ -0,0 +1,646 @@
+/**
+ *  \file semaphoreFutex.c (implementation file)
+ *
+ *  \brief Semaphore management.
+ *
+ *  Implementation based on Linux futexes (build with <tt>SEM_FUTEX</tt> defined; see <tt>semaphore.c</tt> for the
+ *  SVIPC one).
+ *
+ *  The counters of the semaphores are kept in a POSIX shared memory object, named after the creation key, which is
+ *  mapped by every process that connects to the set. A <em>down</em> on a semaphore whose value is positive and an
+ *  <em>up</em> on a semaphore with no process blocked are carried out in user space, with atomic operations; the
+ *  kernel is only entered to block and to wake up processes.
+ *
+ *  Semaphore 0 of the set is reserved for the signalling of the start of operations, as in the SVIPC
+ *  implementation, so the semaphores are located at 1 .. snum.
+ *
+ *  Operations defined on semaphores:
+ *     \li creation of a set of semaphores
+ *     \li connection to a previously created set of semaphores
+ *     \li destruction of a previously created set of semaphores
+ *     \li destruction of a set of semaphores left behind, given its creation key
+ *     \li signalling start of operations
+ *     \li <em>down</em> of a semaphore within the set
+ *     \li <em>up</em> of a semaphore within the set
+ *     \li <em>down</em> and <em>up</em> of a semaphore within the set by several units at once
+ *     \li <em>down</em> and <em>up</em> of several semaphores within the set, one after the other
+ *     \li setting how long a <em>down</em> of a semaphore spins before blocking, and getting its counters
+ *     \li <em>down</em> of a semaphore within the set with a time limit
+ *     \li getting the value of a semaphore within the set.
+ */
+
+#ifdef SEM_FUTEX
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <limits.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+#include "semaphore.h"
+
+/** \brief access permission: user r-w */
+#define  MASK           0600
+
+/** \brief maximum number of sets a process may be connected to */
+#define  SEMTABSIZE     8
+
+/** \brief format of the name of the shared memory object of a set */
+#define  SEMNAME        "/airlift_sem_%d"
+
+/** \brief largest number of CPU pause instructions between two retries of a spinning <em>down</em> */
+#define  MAXBACKOFF     64
+
+/**
+ *  \brief Definition of <em>semaphore</em> data type.
+ */
+typedef struct
+{ /** \brief semaphore value */
+    int val;
+    /** \brief number of processes blocked, or about to block, on the semaphore */
+    int nWaiters;
+    /** \brief number of those processes that wait for more than one unit */
+    int nWideWaiters;
+    /** \brief largest number of retries of a <em>down</em> before blocking */
+    unsigned int spinLimit;
+    /** \brief spin counters */
+    SEM_SPIN_STATS stats;
+
+} FUTEX_SEM;
+
+/**
+ *  \brief Definition of <em>set of semaphores</em> data type (in shared memory).
+ */
+typedef struct
+{ /** \brief number of semaphores in the set, semaphore 0 included */
+    unsigned int snum;
+    /** \brief semaphores */
+    FUTEX_SEM sem[];
+
+} FUTEX_SET;
+
+/**
+ *  \brief Definition of <em>connection to a set</em> data type.
+ */
+typedef struct
+{ /** \brief mapping of the set on the process address space (NULL, if the entry is free) */
+    FUTEX_SET *set;
+    /** \brief size of the mapping */
+    size_t size;
+    /** \brief name of the shared memory object */
+    char name[32];
+
+} SEM_ENTRY;
+
+/** \brief sets the process is connected to; the set identifier is the location in the table */
+static SEM_ENTRY semTab[SEMTABSIZE];
+
+/**
+ *  \brief Blocking while the value at an address is equal to <tt>val</tt>, for <tt>timeout</tt> at most (NULL,
+ *  for ever).
+ */
+
+static int futexWait (int *addr, int val, const struct timespec *timeout)
+{
+  return (int) syscall (SYS_futex, addr, FUTEX_WAIT, val, timeout, NULL, 0);
+}
+
+/**
+ *  \brief Waking up at most <tt>n</tt> processes blocked at an address.
+ */
+
+static int futexWake (int *addr, int n)
+{
+  return (int) syscall (SYS_futex, addr, FUTEX_WAKE, n, NULL, NULL, 0);
+}
+
+/**
+ *  \brief Mapping a shared memory object and storing it in the table.
+ *
+ *  \param fd file descriptor of the shared memory object
+ *  \param size size of the object
+ *  \param name name of the object
+ *
+ *  \return set identifier, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+static int semMap (int fd, size_t size, const char *name)
+{
+  int semgid;                                                                            /* semaphore set identifier */
+  void *map;
+
+  for (semgid = 0; (semgid < SEMTABSIZE) && (semTab[semgid].set != NULL); semgid++)
+    ;
+  if (semgid == SEMTABSIZE)
+     { errno = EMFILE;
+       return -1;
+     }
+  if ((map = mmap (NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)) == MAP_FAILED)
+     return -1;
+  semTab[semgid].set = map;
+  semTab[semgid].size = size;
+  strcpy (semTab[semgid].name, name);
+  return semgid;
+}
+
+/**
+ *  \brief Getting a semaphore within a set.
+ *
+ *  \param semgid set identifier
+ *  \param sindex semaphore location in the set
+ *
+ *  \return pointer to the semaphore, upon success
+ *  \return NULL, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+static FUTEX_SEM *semGet (int semgid, unsigned int sindex)
+{
+  if ((semgid < 0) || (semgid >= SEMTABSIZE) || (semTab[semgid].set == NULL) ||
+      (sindex >= semTab[semgid].set->snum))
+     { errno = EINVAL;
+       return NULL;
+     }
+  return &semTab[semgid].set->sem[sindex];
+}
+
+/**
+ *  \brief Letting the processor know the process is spinning.
+ */
+
+static inline void cpuRelax (void)
+{
+#if defined (__x86_64__) || defined (__i386__)
+  __builtin_ia32_pause ();
+#elif defined (__aarch64__)
+  __asm__ __volatile__ ("yield" ::: "memory");
+#else
+  __asm__ __volatile__ ("" ::: "memory");
+#endif
+}
+
+/**
+ *  \brief <em>Down</em> of a semaphore by <tt>n</tt> units.
+ *
+ *  The value is decremented in user space if it is not lower than <tt>n</tt>; otherwise the operation is retried
+ *  up to the spin limit of the semaphore, with a growing number of pause instructions in between, and then the
+ *  process blocks in the kernel until the value changes. If a deadline is given, the function fails with
+ *  <tt>EAGAIN</tt> once it is reached.
+ *
+ *  \param s pointer to the semaphore
+ *  \param n number of units (>= 1)
+ *  \param deadline time limit on the monotonic clock (NULL, for none)
+ *
+ *  \return \c 0, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+static int futexDown (FUTEX_SEM *s, int n, const struct timespec *deadline)
+{
+  unsigned int limit = __atomic_load_n (&s->spinLimit, __ATOMIC_RELAXED);
+  unsigned int spin = 0, pause = 1, k;
+  bool blocked = false;
+  struct timespec left, t;                                                            /* time left to the deadline */
+  int v, stat;
+
+  for (;;)
+  { v = __atomic_load_n (&s->val, __ATOMIC_RELAXED);
+    while (v >= n)
+      if (__atomic_compare_exchange_n (&s->val, &v, v - n, true, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+         { if ((spin > 0) && !blocked)
+              __atomic_fetch_add (&s->stats.nSpinAcquired, 1, __ATOMIC_RELAXED);
+           return 0;                                                                                     /* fast path */
+         }
+    if (spin < limit)
+       { for (k = 0; k < pause; k++)                                                           /* bounded backoff */
+           cpuRelax ();
+         if (pause < MAXBACKOFF)
+            pause <<= 1;
+         spin += 1;
+         continue;
+       }
+    if (deadline != NULL)
+       { clock_gettime (CLOCK_MONOTONIC, &t);
+         left.tv_sec = deadline->tv_sec - t.tv_sec;
+         left.tv_nsec = deadline->tv_nsec - t.tv_nsec;
+         if (left.tv_nsec < 0)
+            { left.tv_nsec += 1000000000L;
+              left.tv_sec -= 1;
+            }
+         if (left.tv_sec < 0)
+            { errno = EAGAIN;
+              return -1;
+            }
+       }
+    if (limit > 0)
+       { __atomic_fetch_add (&s->stats.nBlocked, 1, __ATOMIC_RELAXED);
+         blocked = true;
+       }
+    __atomic_fetch_add (&s->nWaiters, 1, __ATOMIC_SEQ_CST);
+    if (n > 1)
+       __atomic_fetch_add (&s->nWideWaiters, 1, __ATOMIC_SEQ_CST);
+    stat = futexWait (&s->val, v, (deadline != NULL) ? &left : NULL);    /* at once, if the value changed */
+    if ((stat == -1) && ((errno == EAGAIN) || (errno == EINTR) || (errno == ETIMEDOUT)))
+       stat = 0;
+    if (n > 1)
+       __atomic_fetch_sub (&s->nWideWaiters, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_sub (&s->nWaiters, 1, __ATOMIC_RELAXED);
+    if (stat == -1)
+       return -1;
+  }
+}
+
+/**
+ *  \brief <em>Up</em> of a semaphore by <tt>n</tt> units.
+ *
+ *  The value is incremented in user space; the kernel is only entered if some process may be blocked.
+ *  Up to <tt>n</tt> processes are woken up, or all of them if some process waits for more than one unit (the
+ *  first ones might not be able to proceed).
+ *
+ *  \param s pointer to the semaphore
+ *  \param n number of units (>= 1)
+ *
+ *  \return \c 0, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+static int futexUp (FUTEX_SEM *s, int n)
+{
+  __atomic_fetch_add (&s->val, n, __ATOMIC_SEQ_CST);
+  if (__atomic_load_n (&s->nWaiters, __ATOMIC_SEQ_CST) > 0)
+     { int nWake = (__atomic_load_n (&s->nWideWaiters, __ATOMIC_SEQ_CST) > 0) ? INT_MAX : n;
+
+       return (futexWake (&s->val, nWake) == -1) ? -1 : 0;
+     }
+  return 0;
+}
+
+/**
+ *  \brief Creation of a set of semaphores.
+ *
+ *  All semaphores in the set will be in set to <em>red state</em> upon creation.
+ *  The function fails if there is already a semaphore set with a creation key equal to <tt>key</tt>.
+ *
+ *  \param key creation key
+ *  \param snum number of semaphores in the set (>= 1)
+ *
+ *  \return set identifier, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+int semCreate (int key, unsigned int snum)
+{
+  char name[32];                                                                /* name of the shared memory object */
+  size_t size = sizeof (FUTEX_SET) + (snum + 1) * sizeof (FUTEX_SEM);
+  int fd, semgid;
+
+  sprintf (name, SEMNAME, key);
+  if ((fd = shm_open (name, O_RDWR | O_CREAT | O_EXCL, MASK)) == -1)
+     return -1;
+  if ((ftruncate (fd, (off_t) size) == -1) || ((semgid = semMap (fd, size, name)) == -1))
+     { int err = errno;
+
+       close (fd);
+       shm_unlink (name);
+       errno = err;
+       return -1;
+     }
+  close (fd);
+  semTab[semgid].set->snum = snum + 1;                                    /* the values are 0: all in red state */
+  return semgid;
+}
+
+/**
+ *  \brief Connection to a previously created set of semaphores.
+ *
+ *  The function fails if there is no semaphore set with a creation key equal to <tt>key</tt>.
+ *  The process is blocked until the start of operations is signalled.
+ *
+ *  \param key creation key
+ *
+ *  \return set identifier, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+int semConnect (int key)
+{
+  char name[32];                                                                /* name of the shared memory object */
+  struct stat st;
+  int fd, semgid;
+
+  sprintf (name, SEMNAME, key);
+  if ((fd = shm_open (name, O_RDWR, MASK)) == -1)
+     return -1;
+  if ((fstat (fd, &st) == -1) || ((semgid = semMap (fd, (size_t) st.st_size, name)) == -1))
+     { int err = errno;
+
+       close (fd);
+       errno = err;
+       return -1;
+     }
+  close (fd);
+  if ((futexDown (&semTab[semgid].set->sem[0], 1, NULL) == -1) ||                          /* wait for the start... */
+      (futexUp (&semTab[semgid].set->sem[0], 1) == -1))                                     /* ...and let others pass */
+     return -1;
+  return semgid;
+}
+
+/**
+ *  \brief Destruction of a previously created set of semaphores.
+ *
+ *  The function fails if there is no semaphore set with an identifier equal to <tt>semgid</tt>.
+ *
+ *  \param semgid set identifier
+ *
+ *  \return \c 0, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+int semDestroy (int semgid)
+{
+  if (semGet (semgid, 0) == NULL)
+     return -1;
+  if (shm_unlink (semTab[semgid].name) == -1)
+     return -1;
+  munmap (semTab[semgid].set, semTab[semgid].size);
+  semTab[semgid].set = NULL;
+  return 0;
+}
+
+/**
+ *  \brief Destruction of a set of semaphores left behind, given its creation key.
+ *
+ *  The name of the shared memory object is removed; the processes blocked on the set, if any, stay blocked.
+ *  The function fails if there is no semaphore set with a creation key equal to <tt>key</tt>.
+ *
+ *  \param key creation key
+ *
+ *  \return \c 0, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+int semReclaim (int key)
+{
+  char name[32];                                                                /* name of the shared memory object */
+
+  sprintf (name, SEMNAME, key);
+  return shm_unlink (name);
+}
+
+/**
+ *  \brief Signalling start of operations upon initialization of shared data structures.
+ *
+ *  The function fails if there is no semaphore set with an identifier equal to <tt>semgid</tt>.
+ *
+ *  \param semgid set identifier
+ *
+ *  \return \c 0, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+int semSignal (int semgid)
+{
+  FUTEX_SEM *s;
+
+  if ((s = semGet (semgid, 0)) == NULL)
+     return -1;
+  return futexUp (s, 1);
+}
+
+/**
+ *  \brief <em>Down</em> of a semaphore within the set.
+ *
+ *  The function fails if there is no semaphore set with an identifier equal to <tt>semgid</tt>.
+ *
+ *  \param semgid set identifier
+ *  \param sindex semaphore location in the set (1 .. snum)
+ *
+ *  \return \c 0, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+int semDown (int semgid, unsigned int sindex)
+{
+  FUTEX_SEM *s;
+
+  if ((s = semGet (semgid, sindex)) == NULL)
+     return -1;
+  return futexDown (s, 1, NULL);
+}
+
+/**
+ *  \brief <em>Up</em> of a semaphore within the set.
+ *
+ *  The function fails if there is no semaphore set with an identifier equal to <tt>semgid</tt>.
+ *
+ *  \param semgid set identifier
+ *  \param sindex semaphore location in the set (1 .. snum)
+ *
+ *  \return \c 0, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+int semUp (int semgid, unsigned int sindex)
+{
+  FUTEX_SEM *s;
+
+  if ((s = semGet (semgid, sindex)) == NULL)
+     return -1;
+  return futexUp (s, 1);
+}
+
+/**
+ *  \brief <em>Down</em> of a semaphore within the set by <tt>n</tt> units.
+ *
+ *  The <tt>n</tt> units are taken at once.
+ *  The function fails if there is no semaphore set with an identifier equal to <tt>semgid</tt>.
+ *
+ *  \param semgid set identifier
+ *  \param sindex semaphore location in the set (1 .. snum)
+ *  \param n number of units
+ *
+ *  \return \c 0, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+int semDownN (int semgid, unsigned int sindex, unsigned int n)
+{
+  FUTEX_SEM *s;
+
+  if ((s = semGet (semgid, sindex)) == NULL)
+     return -1;
+  if (n > INT_MAX)
+     { errno = EINVAL;
+       return -1;
+     }
+  return (n == 0) ? 0 : futexDown (s, (int) n, NULL);
+}
+
+/**
+ *  \brief <em>Up</em> of a semaphore within the set by <tt>n</tt> units.
+ *
+ *  The value is incremented once and the kernel is entered at most once.
+ *  The function fails if there is no semaphore set with an identifier equal to <tt>semgid</tt>.
+ *
+ *  \param semgid set identifier
+ *  \param sindex semaphore location in the set (1 .. snum)
+ *  \param n number of units
+ *
+ *  \return \c 0, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+int semUpN (int semgid, unsigned int sindex, unsigned int n)
+{
+  FUTEX_SEM *s;
+
+  if ((s = semGet (semgid, sindex)) == NULL)
+     return -1;
+  if (n > INT_MAX)
+     { errno = EINVAL;
+       return -1;
+     }
+  return (n == 0) ? 0 : futexUp (s, (int) n);
+}
+
+/**
+ *  \brief <em>Down</em> and <em>up</em> of several semaphores within the set at once.
+ *
+ *  The operations are carried out one after the other, in the given order: they are not atomic as a whole (an
+ *  uncontended operation does not enter the kernel anyway).
+ *  The function fails if there is no semaphore set with an identifier equal to <tt>semgid</tt>, or if
+ *  <tt>nOps</tt> is larger than <tt>SEMOPSMAX</tt>.
+ *
+ *  \param semgid set identifier
+ *  \param ops operations
+ *  \param nOps number of operations
+ *
+ *  \return \c 0, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+int semOps (int semgid, const SEM_OP ops[], unsigned int nOps)
+{
+  unsigned int i;
+  int stat = 0;
+
+  if (nOps > SEMOPSMAX)
+     { errno = E2BIG;
+       return -1;
+     }
+  for (i = 0; (i < nOps) && (stat == 0); i++)
+    if (ops[i].delta > 0)
+       stat = semUpN (semgid, ops[i].sindex, (unsigned int) ops[i].delta);
+       else if (ops[i].delta < 0)
+               stat = semDownN (semgid, ops[i].sindex, (unsigned int) -ops[i].delta);
+  return stat;
+}
+
+/**
+ *  \brief Setting the spin limit of a semaphore within the set.
+ *
+ *  The function fails if there is no semaphore set with an identifier equal to <tt>semgid</tt>.
+ *
+ *  \param semgid set identifier
+ *  \param sindex semaphore location in the set (1 .. snum)
+ *  \param limit largest number of retries
+ *
+ *  \return \c 0, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+int semSetSpin (int semgid, unsigned int sindex, unsigned int limit)
+{
+  FUTEX_SEM *s;
+
+  if ((s = semGet (semgid, sindex)) == NULL)
+     return -1;
+  __atomic_store_n (&s->spinLimit, limit, __ATOMIC_RELAXED);
+  return 0;
+}
+
+/**
+ *  \brief Getting the spin counters of a semaphore within the set.
+ *
+ *  The function fails if there is no semaphore set with an identifier equal to <tt>semgid</tt>.
+ *
+ *  \param semgid set identifier
+ *  \param sindex semaphore location in the set (1 .. snum)
+ *  \param stats pointer to the location where the counters are stored
+ *
+ *  \return \c 0, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+int semSpinStats (int semgid, unsigned int sindex, SEM_SPIN_STATS *stats)
+{
+  FUTEX_SEM *s;
+
+  if ((s = semGet (semgid, sindex)) == NULL)
+     return -1;
+  stats->nSpinAcquired = __atomic_load_n (&s->stats.nSpinAcquired, __ATOMIC_RELAXED);
+  stats->nBlocked = __atomic_load_n (&s->stats.nBlocked, __ATOMIC_RELAXED);
+  return 0;
+}
+
+/**
+ *  \brief <em>Down</em> of a semaphore within the set with a time limit.
+ *
+ *  The function fails with <tt>EAGAIN</tt> upon timeout, or if there is no semaphore set with an identifier equal
+ *  to <tt>semgid</tt>.
+ *
+ *  \param semgid set identifier
+ *  \param sindex semaphore location in the set (1 .. snum)
+ *  \param timeout time limit (in ms)
+ *
+ *  \return \c 0, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+int semDownTimed (int semgid, unsigned int sindex, unsigned int timeout)
+{
+  FUTEX_SEM *s;
+  struct timespec deadline;
+
+  if ((s = semGet (semgid, sindex)) == NULL)
+     return -1;
+  clock_gettime (CLOCK_MONOTONIC, &deadline);
+  deadline.tv_sec += timeout / 1000;
+  deadline.tv_nsec += (long) (timeout % 1000) * 1000000L;
+  if (deadline.tv_nsec >= 1000000000L)
+     { deadline.tv_nsec -= 1000000000L;
+       deadline.tv_sec += 1;
+     }
+  return futexDown (s, 1, &deadline);
+}
+
+/**
+ *  \brief Getting the value of a semaphore within the set.
+ *
+ *  The function fails if there is no semaphore set with an identifier equal to <tt>semgid</tt>.
+ *
+ *  \param semgid set identifier
+ *  \param sindex semaphore location in the set (0 .. snum)
+ *
+ *  \return value of the semaphore, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+int semGetValue (int semgid, unsigned int sindex)
+{
+  FUTEX_SEM *s;
+
+  if ((s = semGet (semgid, sindex)) == NULL)
+     return -1;
+  return __atomic_load_n (&s->val, __ATOMIC_RELAXED);
+}
+
+#endif /* SEM_FUTEX */
@@ -0,0 +1,536 @@
+/**
+ *  \file semaphorePosix.c (implementation file)
+ *
+ *  \brief Semaphore management.
+ *
+ *  Implementation based on POSIX process-shared semaphores (build with <tt>SEM_POSIX</tt> defined; see
+ *  <tt>semaphore.c</tt> for the SVIPC one).
+ *
+ *  The semaphores are <tt>sem_t</tt> objects initialized with <tt>pshared</tt> set, kept in a <tt>SEM_SET</tt> at
+ *  the start of the shared memory block with the same creation key (see <tt>sharedDataSync.h</tt>), so the block
+ *  must be created before the set. glibc carries out uncontended operations in user space.
+ *  The signalling of the start of operations goes through a gate made of a process-shared mutex and condition
+ *  variable, instead of semaphore 0.
+ *
+ *  Operations defined on semaphores:
+ *     \li creation of a set of semaphores
+ *     \li connection to a previously created set of semaphores
+ *     \li destruction of a previously created set of semaphores
+ *     \li destruction of a set of semaphores left behind, given its creation key
+ *     \li signalling start of operations
+ *     \li <em>down</em> of a semaphore within the set
+ *     \li <em>up</em> of a semaphore within the set
+ *     \li <em>down</em> and <em>up</em> of a semaphore within the set by several units at once
+ *     \li <em>down</em> and <em>up</em> of several semaphores within the set, one after the other
+ *     \li setting how long a <em>down</em> of a semaphore spins before blocking, and getting its counters
+ *     \li <em>down</em> of a semaphore within the set with a time limit
+ *     \li getting the value of a semaphore within the set.
+ */
+
+#ifdef SEM_POSIX
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <sys/types.h>
+
+#include "semaphore.h"
+#include "sharedMemory.h"
+
+/** \brief maximum number of sets a process may be connected to */
+#define  SEMTABSIZE     8
+
+/** \brief largest number of CPU pause instructions between two retries of a spinning <em>down</em> */
+#define  MAXBACKOFF     64
+
+/** \brief sets the process is connected to (NULL, if the entry is free); the set identifier is the location */
+static SEM_SET *semTab[SEMTABSIZE];
+
+/**
+ *  \brief Mapping the shared memory block that holds the set and storing it in the table.
+ *
+ *  \param key creation key
+ *
+ *  \return set identifier, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+static int semMap (int key)
+{
+  int semgid;                                                                            /* semaphore set identifier */
+  int shmid;                                                                      /* shared memory block identifier */
+  void *addr;
+
+  for (semgid = 0; (semgid < SEMTABSIZE) && (semTab[semgid] != NULL); semgid++)
+    ;
+  if (semgid == SEMTABSIZE)
+     { errno = EMFILE;
+       return -1;
+     }
+  if ((shmid = shmemConnect (key)) == -1)
+     return -1;
+  if (shmemAttach (shmid, &addr) == -1)
+     return -1;
+  semTab[semgid] = addr;
+  return semgid;
+}
+
+/**
+ *  \brief Getting a semaphore within a set.
+ *
+ *  \param semgid set identifier
+ *  \param sindex semaphore location in the set
+ *
+ *  \return pointer to the semaphore, upon success
+ *  \return NULL, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+static sem_t *semGet (int semgid, unsigned int sindex)
+{
+  if ((semgid < 0) || (semgid >= SEMTABSIZE) || (semTab[semgid] == NULL) || (sindex >= semTab[semgid]->snum))
+     { errno = EINVAL;
+       return NULL;
+     }
+  return &semTab[semgid]->sem[sindex];
+}
+
+/**
+ *  \brief Letting the processor know the process is spinning.
+ */
+
+static inline void cpuRelax (void)
+{
+#if defined (__x86_64__) || defined (__i386__)
+  __builtin_ia32_pause ();
+#elif defined (__aarch64__)
+  __asm__ __volatile__ ("yield" ::: "memory");
+#else
+  __asm__ __volatile__ ("" ::: "memory");
+#endif
+}
+
+/**
+ *  \brief <em>Down</em> of a semaphore within a set.
+ *
+ *  If the spin limit of the semaphore is not 0, <tt>sem_trywait</tt> is retried up to the limit, with a growing
+ *  number of pause instructions in between, before blocking in <tt>sem_wait</tt>.
+ *
+ *  \param set pointer to the set
+ *  \param sindex semaphore location in the set
+ *
+ *  \return \c 0, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+static int posixDown (SEM_SET *set, unsigned int sindex)
+{
+  sem_t *s = &set->sem[sindex];
+  unsigned int limit = __atomic_load_n (&set->spinLimit[sindex], __ATOMIC_RELAXED);
+  unsigned int spin, pause = 1, k;
+  int stat;
+
+  if (limit > 0)
+     { for (spin = 0; spin <= limit; spin++)
+         { if (sem_trywait (s) == 0)
+              { if (spin > 0)
+                   __atomic_fetch_add (&set->spinStats[sindex].nSpinAcquired, 1, __ATOMIC_RELAXED);
+                return 0;
+              }
+           if (errno != EAGAIN)
+              return -1;
+           for (k = 0; k < pause; k++)                                                         /* bounded backoff */
+             cpuRelax ();
+           if (pause < MAXBACKOFF)
+              pause <<= 1;
+         }
+       __atomic_fetch_add (&set->spinStats[sindex].nBlocked, 1, __ATOMIC_RELAXED);
+     }
+  while (((stat = sem_wait (s)) == -1) && (errno == EINTR))
+    ;
+  return stat;
+}
+
+/**
+ *  \brief Creation of a set of semaphores.
+ *
+ *  All semaphores in the set will be in set to <em>red state</em> upon creation.
+ *  The function fails if there is no shared memory block with a creation key equal to <tt>key</tt>.
+ *
+ *  \param key creation key
+ *  \param snum number of semaphores in the set (>= 1)
+ *
+ *  \return set identifier, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+int semCreate (int key, unsigned int snum)
+{
+  int semgid;                                                                            /* semaphore set identifier */
+  SEM_SET *set;
+  pthread_mutexattr_t mattr;
+  pthread_condattr_t cattr;
+  unsigned int s;
+
+  if (snum + 1 > SEMPOSIXMAX)
+     { errno = EINVAL;
+       return -1;
+     }
+  if ((semgid = semMap (key)) == -1)
+     return -1;
+  set = semTab[semgid];
+
+  pthread_mutexattr_init (&mattr);
+  pthread_mutexattr_setpshared (&mattr, PTHREAD_PROCESS_SHARED);
+  pthread_condattr_init (&cattr);
+  pthread_condattr_setpshared (&cattr, PTHREAD_PROCESS_SHARED);
+  errno = pthread_mutex_init (&set->lock, &mattr);
+  if (errno == 0)
+     errno = pthread_cond_init (&set->open, &cattr);
+  pthread_mutexattr_destroy (&mattr);
+  pthread_condattr_destroy (&cattr);
+  if (errno != 0)
+     return -1;
+  set->started = false;
+
+  set->snum = snum + 1;
+  for (s = 0; s < set->snum; s++)
+  { if (sem_init (&set->sem[s], 1, 0) == -1)                                                    /* process-shared */
+       return -1;
+    set->spinLimit[s] = 0;
+    set->spinStats[s].nSpinAcquired = set->spinStats[s].nBlocked = 0;
+  }
+  return semgid;
+}
+
+/**
+ *  \brief Connection to a previously created set of semaphores.
+ *
+ *  The function fails if there is no shared memory block with a creation key equal to <tt>key</tt>.
+ *  The process is blocked until the start of operations is signalled.
+ *
+ *  \param key creation key
+ *
+ *  \return set identifier, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+int semConnect (int key)
+{
+  int semgid;                                                                            /* semaphore set identifier */
+  SEM_SET *set;
+
+  if ((semgid = semMap (key)) == -1)
+     return -1;
+  set = semTab[semgid];
+  if ((errno = pthread_mutex_lock (&set->lock)) != 0)
+     return -1;
+  while (!set->started)
+    pthread_cond_wait (&set->open, &set->lock);
+  pthread_mutex_unlock (&set->lock);
+  return semgid;
+}
+
+/**
+ *  \brief Destruction of a previously created set of semaphores.
+ *
+ *  The function fails if there is no semaphore set with an identifier equal to <tt>semgid</tt>.
+ *  The shared memory block that holds the set is not destroyed.
+ *
+ *  \param semgid set identifier
+ *
+ *  \return \c 0, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+int semDestroy (int semgid)
+{
+  SEM_SET *set;
+  unsigned int s;
+
+  if (semGet (semgid, 0) == NULL)
+     return -1;
+  set = semTab[semgid];
+  for (s = 0; s < set->snum; s++)
+    sem_destroy (&set->sem[s]);
+  pthread_cond_destroy (&set->open);
+  pthread_mutex_destroy (&set->lock);
+  semTab[semgid] = NULL;
+  return shmemDettach (set);
+}
+
+/**
+ *  \brief Destruction of a set of semaphores left behind, given its creation key.
+ *
+ *  The set lives in the shared memory block with the same key and goes with it (see <tt>shmemReclaim</tt>), so
+ *  there is nothing else to destroy: the function always succeeds.
+ *
+ *  \param key creation key
+ *
+ *  \return \c 0
+ */
+
+int semReclaim (int key)
+{
+  return 0;
+}
+
+/**
+ *  \brief Signalling start of operations upon initialization of shared data structures.
+ *
+ *  The function fails if there is no semaphore set with an identifier equal to <tt>semgid</tt>.
+ *
+ *  \param semgid set identifier
+ *
+ *  \return \c 0, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+int semSignal (int semgid)
+{
+  SEM_SET *set;
+
+  if (semGet (semgid, 0) == NULL)
+     return -1;
+  set = semTab[semgid];
+  if ((errno = pthread_mutex_lock (&set->lock)) != 0)
+     return -1;
+  set->started = true;
+  pthread_cond_broadcast (&set->open);
+  pthread_mutex_unlock (&set->lock);
+  return 0;
+}
+
+/**
+ *  \brief <em>Down</em> of a semaphore within the set.
+ *
+ *  The function fails if there is no semaphore set with an identifier equal to <tt>semgid</tt>.
+ *
+ *  \param semgid set identifier
+ *  \param sindex semaphore location in the set (1 .. snum)
+ *
+ *  \return \c 0, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+int semDown (int semgid, unsigned int sindex)
+{
+  if (semGet (semgid, sindex) == NULL)
+     return -1;
+  return posixDown (semTab[semgid], sindex);
+}
+
+/**
+ *  \brief <em>Up</em> of a semaphore within the set.
+ *
+ *  The function fails if there is no semaphore set with an identifier equal to <tt>semgid</tt>.
+ *
+ *  \param semgid set identifier
+ *  \param sindex semaphore location in the set (1 .. snum)
+ *
+ *  \return \c 0, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+int semUp (int semgid, unsigned int sindex)
+{
+  sem_t *s;
+
+  if ((s = semGet (semgid, sindex)) == NULL)
+     return -1;
+  return sem_post (s);
+}
+
+/**
+ *  \brief <em>Down</em> of a semaphore within the set by <tt>n</tt> units.
+ *
+ *  POSIX semaphores have no such operation, so <tt>n</tt> <em>down</em> operations are carried out one after
+ *  the other: the units are not taken all at once.
+ *  The function fails if there is no semaphore set with an identifier equal to <tt>semgid</tt>.
+ *
+ *  \param semgid set identifier
+ *  \param sindex semaphore location in the set (1 .. snum)
+ *  \param n number of units
+ *
+ *  \return \c 0, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+int semDownN (int semgid, unsigned int sindex, unsigned int n)
+{
+  int stat = 0;
+
+  if (semGet (semgid, sindex) == NULL)
+     return -1;
+  for (; (n > 0) && (stat == 0); n--)
+    stat = posixDown (semTab[semgid], sindex);
+  return stat;
+}
+
+/**
+ *  \brief <em>Up</em> of a semaphore within the set by <tt>n</tt> units.
+ *
+ *  POSIX semaphores have no such operation, so <tt>n</tt> <em>up</em> operations are carried out one after the
+ *  other (in user space, if no process is blocked).
+ *  The function fails if there is no semaphore set with an identifier equal to <tt>semgid</tt>.
+ *
+ *  \param semgid set identifier
+ *  \param sindex semaphore location in the set (1 .. snum)
+ *  \param n number of units
+ *
+ *  \return \c 0, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+int semUpN (int semgid, unsigned int sindex, unsigned int n)
+{
+  sem_t *s;
+
+  if ((s = semGet (semgid, sindex)) == NULL)
+     return -1;
+  for (; n > 0; n--)
+    if (sem_post (s) == -1)
+       return -1;
+  return 0;
+}
+
+/**
+ *  \brief <em>Down</em> and <em>up</em> of several semaphores within the set at once.
+ *
+ *  POSIX semaphores have no such operation, so the operations are carried out one after the other, in the given
+ *  order: they are not atomic as a whole.
+ *  The function fails if there is no semaphore set with an identifier equal to <tt>semgid</tt>, or if
+ *  <tt>nOps</tt> is larger than <tt>SEMOPSMAX</tt>.
+ *
+ *  \param semgid set identifier
+ *  \param ops operations
+ *  \param nOps number of operations
+ *
+ *  \return \c 0, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+int semOps (int semgid, const SEM_OP ops[], unsigned int nOps)
+{
+  unsigned int i;
+  int stat = 0;
+
+  if (nOps > SEMOPSMAX)
+     { errno = E2BIG;
+       return -1;
+     }
+  for (i = 0; (i < nOps) && (stat == 0); i++)
+    if (ops[i].delta > 0)
+       stat = semUpN (semgid, ops[i].sindex, (unsigned int) ops[i].delta);
+       else if (ops[i].delta < 0)
+               stat = semDownN (semgid, ops[i].sindex, (unsigned int) -ops[i].delta);
+  return stat;
+}
+
+/**
+ *  \brief Setting the spin limit of a semaphore within the set.
+ *
+ *  The function fails if there is no semaphore set with an identifier equal to <tt>semgid</tt>.
+ *
+ *  \param semgid set identifier
+ *  \param sindex semaphore location in the set (1 .. snum)
+ *  \param limit largest number of retries
+ *
+ *  \return \c 0, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+int semSetSpin (int semgid, unsigned int sindex, unsigned int limit)
+{
+  if (semGet (semgid, sindex) == NULL)
+     return -1;
+  __atomic_store_n (&semTab[semgid]->spinLimit[sindex], limit, __ATOMIC_RELAXED);
+  return 0;
+}
+
+/**
+ *  \brief Getting the spin counters of a semaphore within the set.
+ *
+ *  The function fails if there is no semaphore set with an identifier equal to <tt>semgid</tt>.
+ *
+ *  \param semgid set identifier
+ *  \param sindex semaphore location in the set (1 .. snum)
+ *  \param stats pointer to the location where the counters are stored
+ *
+ *  \return \c 0, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+int semSpinStats (int semgid, unsigned int sindex, SEM_SPIN_STATS *stats)
+{
+  SEM_SPIN_STATS *st;
+
+  if (semGet (semgid, sindex) == NULL)
+     return -1;
+  st = &semTab[semgid]->spinStats[sindex];
+  stats->nSpinAcquired = __atomic_load_n (&st->nSpinAcquired, __ATOMIC_RELAXED);
+  stats->nBlocked = __atomic_load_n (&st->nBlocked, __ATOMIC_RELAXED);
+  return 0;
+}
+
+/**
+ *  \brief <em>Down</em> of a semaphore within the set with a time limit.
+ *
+ *  <tt>sem_timedwait</tt> takes the time limit on the real time clock. The function fails with <tt>EAGAIN</tt>
+ *  upon timeout, or if there is no semaphore set with an identifier equal to <tt>semgid</tt>.
+ *
+ *  \param semgid set identifier
+ *  \param sindex semaphore location in the set (1 .. snum)
+ *  \param timeout time limit (in ms)
+ *
+ *  \return \c 0, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+int semDownTimed (int semgid, unsigned int sindex, unsigned int timeout)
+{
+  sem_t *s;
+  struct timespec deadline;
+  int stat;
+
+  if ((s = semGet (semgid, sindex)) == NULL)
+     return -1;
+  clock_gettime (CLOCK_REALTIME, &deadline);
+  deadline.tv_sec += timeout / 1000;
+  deadline.tv_nsec += (long) (timeout % 1000) * 1000000L;
+  if (deadline.tv_nsec >= 1000000000L)
+     { deadline.tv_nsec -= 1000000000L;
+       deadline.tv_sec += 1;
+     }
+  while (((stat = sem_timedwait (s, &deadline)) == -1) && (errno == EINTR))
+    ;
+  if ((stat == -1) && (errno == ETIMEDOUT))
+     errno = EAGAIN;
+  return stat;
+}
+
+/**
+ *  \brief Getting the value of a semaphore within the set.
+ *
+ *  The function fails if there is no semaphore set with an identifier equal to <tt>semgid</tt>.
+ *
+ *  \param semgid set identifier
+ *  \param sindex semaphore location in the set (0 .. snum)
+ *
+ *  \return value of the semaphore, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+int semGetValue (int semgid, unsigned int sindex)
+{
+  sem_t *s;
+  int val;
+
+  if ((s = semGet (semgid, sindex)) == NULL)
+     return -1;
+  return (sem_getvalue (s, &val) == -1) ? -1 : val;
+}
+
+#endif /* SEM_POSIX */
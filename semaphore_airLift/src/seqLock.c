@@ -0,0 +1,52 @@
+/**
+ *  \file seqLock.c (implementation file)
+ *
+ *  \brief Problem name: Air Lift.
+ *
+ *  \brief Sequence counter of a shared object, for lock-free observers.
+ *
+ *  The copy is taken with <tt>memcpy</tt> while writers may be updating the object; it is only used when the
+ *  counter shows that no update overlapped it, the usual way of reading under a sequence counter.
+ */
+
+#include <string.h>
+#include <errno.h>
+#include <sched.h>
+
+#include "seqLock.h"
+
+/**
+ *  \brief Taking a consistent copy of the object without locking.
+ *
+ *  \param sl pointer to the sequence counter
+ *  \param src pointer to the object
+ *  \param dst pointer to the copy
+ *  \param size size of the object (in bytes)
+ *  \param maxTries largest number of copies taken
+ *
+ *  \return \c 0, upon success
+ *  \return -\c 1, if no consistent copy was taken within <tt>maxTries</tt> (<tt>errno</tt> is set to
+ *          <tt>EAGAIN</tt>)
+ */
+
+int seqRead (const SEQ_LOCK *sl, const void *src, void *dst, size_t size, unsigned int maxTries)
+{
+    unsigned int before, after, t;
+
+    for (t = 0; t < maxTries; t++) {
+        if (t > 0) {
+            sched_yield ();
+        }
+        if ((before = __atomic_load_n (&sl->seq, __ATOMIC_ACQUIRE)) & 1) {                       /* update going on */
+            continue;
+        }
+        memcpy (dst, src, size);
+        __atomic_thread_fence (__ATOMIC_ACQUIRE);                   /* the copy is taken before the counter is read */
+        after = __atomic_load_n (&sl->seq, __ATOMIC_RELAXED);
+        if (before == after) {
+            return 0;
+        }
+    }
+    errno = EAGAIN;
+    return -1;
+}
@@ -0,0 +1,71 @@
+/**
+ *  \file seqLock.h (interface file)
+ *
+ *  \brief Problem name: Air Lift.
+ *
+ *  \brief Sequence counter of a shared object, for lock-free observers.
+ *
+ *  The writers of the object, which already hold mutual exclusion among themselves (the critical region), make the
+ *  counter odd before updating it and even again afterwards. An observer takes a copy without entering the critical
+ *  region, and retries if the counter was odd or changed while it was copying (a torn read).
+ *
+ *  For the writers, it amounts to two plain stores per critical region on x86 (release ordering needs no fence
+ *  there), so the simulation is not slowed down.
+ */
+
+#ifndef SEQLOCK_H_
+#define SEQLOCK_H_
+
+#include <stddef.h>
+
+/**
+ *  \brief Definition of <em>sequence counter</em> data type (in shared memory, 0 upon creation).
+ */
+typedef struct
+        { /** \brief number of updates started plus number of updates finished (odd, during an update) */
+          unsigned int seq;
+
+        } SEQ_LOCK;
+
+/**
+ *  \brief Starting an update of the object (upon entering the critical region).
+ *
+ *  \param sl pointer to the sequence counter
+ */
+
+static inline void seqWriteBegin (SEQ_LOCK *sl)
+{
+    __atomic_store_n (&sl->seq, sl->seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence (__ATOMIC_RELEASE);                        /* the odd counter is seen before the updates */
+}
+
+/**
+ *  \brief Finishing an update of the object (before exiting the critical region).
+ *
+ *  \param sl pointer to the sequence counter
+ */
+
+static inline void seqWriteEnd (SEQ_LOCK *sl)
+{
+    __atomic_store_n (&sl->seq, sl->seq + 1, __ATOMIC_RELEASE);           /* the updates are seen before the counter */
+}
+
+/**
+ *  \brief Taking a consistent copy of the object without locking.
+ *
+ *  The copy is retried while it is torn; between retries, the processor is yielded to let the writer finish.
+ *
+ *  \param sl pointer to the sequence counter
+ *  \param src pointer to the object
+ *  \param dst pointer to the copy
+ *  \param size size of the object (in bytes)
+ *  \param maxTries largest number of copies taken
+ *
+ *  \return \c 0, upon success
+ *  \return -\c 1, if no consistent copy was taken within <tt>maxTries</tt> (<tt>errno</tt> is set to
+ *          <tt>EAGAIN</tt>): a writer is stalled in the middle of an update, or updates never stop
+ */
+
+extern int seqRead (const SEQ_LOCK *sl, const void *src, void *dst, size_t size, unsigned int maxTries);
+
+#endif /* SEQLOCK_H_ */
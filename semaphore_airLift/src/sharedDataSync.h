@@ -19,12 +19,22 @@
 
 #include "probConst.h"
 #include "probDataStruct.h"
+#include "logging.h"
+#include "semaphore.h"
+#include "semStats.h"
+#include "seqLock.h"
 
 /**
  *  \brief Definition of <em>shared information</em> data type.
  */
 typedef struct
-        { /** \brief full state of the problem */
+        {
+#ifdef SEM_POSIX
+          /** \brief semaphores of the POSIX build (they must be at the start of the region) */
+          SEM_SET sem;
+
+#endif
+          /** \brief full state of the problem */
           FULL_STAT fSt;
 
           /* semaphores ids */
@@ -45,6 +55,19 @@ typedef struct
           /** \brief identification of semaphore used by pilot to wait for last passenger to leave plane - val = 0 */
           unsigned int planeEmpty;
 
+          /** \brief logging data shared by all the intervening entities (event ring of the binary build) */
+          LOG_SHARED log;
+
+          /** \brief sequence counter of the full state, updated upon entering and before exiting the critical region
+           *         (see <tt>seqLock.h</tt>); after the fields above, so the precompiled entities still match the layout */
+          SEQ_LOCK fStSeq;
+
+#ifdef SEM_STATS
+          /** \brief statistics of the semaphore operations (instrumented build) */
+          SEM_STATS_AREA semStats;
+
+#endif
+
         } SHARED_DATA;
 
 /** \brief number of semaphores in the set */
@@ -59,4 +82,9 @@ typedef struct
 #define IDSHOWN                    7
 #define PLANEEMPTY                 8
 
+/** \brief names of the semaphores, by location in the set (semaphore 0 signals the start of operations) */
+#define SEM_NAMES                 { "start", "mutex", "passengersInQueue", "passengersWaitInQueue", \
+                                    "passengersWaitInFlight", "readyForBoarding", "readyToFlight", "idShown", \
+                                    "planeEmpty" }
+
 #endif /* SHAREDDATASYNC_H_ */
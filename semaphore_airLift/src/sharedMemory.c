@@ -3,16 +3,22 @@
  *
  *  \brief Shared memory management.
  *
+ *  Implementation based on SVIPC shared memory (see <tt>sharedMemoryPosix.c</tt> for the one based on POSIX
+ *  shared memory objects, built with <tt>SHM_POSIX</tt> defined).
+ *
  *   Operations defined on shared memory:
  *      \li creation of a new block
  *      \li connection to a previously created block
  *      \li destruction of a previously created block
+ *      \li destruction of a block left behind, given its creation key
  *      \li mapping of the block previously created on the process address space
  *      \li unmapping of the block off the process address space.
  *
  *  \author António Rui Borges - October 1995
  */
 
+#ifndef SHM_POSIX
+
 #include <stdio.h>
 #include <sys/types.h>
 #include <sys/shm.h>
@@ -69,6 +75,27 @@ int shmemDestroy (int shmid)
   return shmctl (shmid, IPC_RMID, (struct shmid_ds *) NULL);
 }
 
+/**
+ *  \brief Destruction of a block left behind, given its creation key.
+ *
+ *  The memory is released when the last process detaches it.
+ *  The function fails if there is no block with a creation key equal to <tt>key</tt>.
+ *
+ *  \param key creation key
+ *
+ *  \return \c 0, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+int shmemReclaim (int key)
+{
+  int shmid;                                                                                  /* block identifier */
+
+  if ((shmid = shmget ((key_t) key, 0, MASK)) == -1)
+     return -1;
+  return shmctl (shmid, IPC_RMID, (struct shmid_ds *) NULL);
+}
+
 /**
  *  \brief Mapping of the block previously created on the process address space.
  *
@@ -90,7 +117,7 @@ int shmemAttach (int shmid, void **pAttAdd)
      { *pAttAdd = (void *) add;
        return 0;
      }
-     else return 1;
+     else return -1;
 }
 
 /**
@@ -109,3 +136,5 @@ int shmemDettach (void *attAdd)
 {
   return shmdt (attAdd);
 }
+
+#endif /* SHM_POSIX */
@@ -7,6 +7,7 @@
  *      \li creation of a new block
  *      \li connection to a previously created block
  *      \li destruction of a previously created block
+ *      \li destruction of a block left behind, given its creation key
  *      \li mapping of the block previously created on the process address space
  *      \li unmapping of the block off the process address space.
  *
@@ -56,6 +57,20 @@ extern int shmemConnect (int key);
 
 extern int shmemDestroy (int shmid);
 
+/**
+ *  \brief Destruction of a block left behind, given its creation key.
+ *
+ *  The memory is released when the last process unmaps it (see <tt>ipcRegistry.h</tt>).
+ *  The function fails if there is no block with a creation key equal to <tt>key</tt>.
+ *
+ *  \param key creation key
+ *
+ *  \return \c 0, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+extern int shmemReclaim (int key);
+
 /**
  *  \brief Mapping of the block previously created on the process address space.
  *
@@ -0,0 +1,282 @@
+/**
+ *  \file sharedMemoryPosix.c (implementation file)
+ *
+ *  \brief Shared memory management.
+ *
+ *  Implementation based on POSIX shared memory objects (build with <tt>SHM_POSIX</tt> defined; see
+ *  <tt>sharedMemory.c</tt> for the SVIPC one).
+ *
+ *  A block is a shared memory object named after the creation key, so a block left behind by a run that did not
+ *  terminate properly shows up in <tt>/dev/shm</tt> and can be removed as a file. The block identifier is the
+ *  location of the block in a table of the process, which keeps the open object and its mapping.
+ *
+ *  When built with <tt>SHM_HUGEPAGES</tt> defined as well, the size of a block is rounded up to a multiple of the
+ *  huge page size and the mapping is advised to be backed by transparent huge pages (<tt>MADV_HUGEPAGE</tt>), which
+ *  takes effect if <tt>/sys/kernel/mm/transparent_hugepage/shmem_enabled</tt> is <tt>advise</tt> or
+ *  <tt>always</tt>. <tt>MAP_HUGETLB</tt> itself only applies to anonymous mappings, so it cannot be used for
+ *  named objects.
+ *
+ *   Operations defined on shared memory:
+ *      \li creation of a new block
+ *      \li connection to a previously created block
+ *      \li destruction of a previously created block
+ *      \li destruction of a block left behind, given its creation key
+ *      \li mapping of the block previously created on the process address space
+ *      \li unmapping of the block off the process address space.
+ */
+
+#ifdef SHM_POSIX
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+
+/** \brief access permission: user r-w */
+#define  MASK           0600
+
+/** \brief maximum number of blocks a process may be connected to */
+#define  SHMTABSIZE     8
+
+/** \brief format of the name of the shared memory object of a block */
+#define  SHMNAME        "/airlift_shm_%d"
+
+/** \brief huge page size (the size of a block is rounded up to a multiple of it, if <tt>SHM_HUGEPAGES</tt>) */
+#define  HUGEPAGESIZE   (2UL << 20)
+
+/**
+ *  \brief Definition of <em>connection to a block</em> data type.
+ */
+typedef struct
+{ /** \brief file descriptor of the shared memory object (-1, if the entry is free) */
+    int fd;
+    /** \brief size of the block */
+    size_t size;
+    /** \brief mapping of the block on the process address space (NULL, if not mapped) */
+    void *addr;
+    /** \brief name of the shared memory object */
+    char name[32];
+
+} SHM_ENTRY;
+
+/** \brief blocks the process is connected to; the block identifier is the location in the table */
+static SHM_ENTRY shmTab[SHMTABSIZE] = {[0 ... SHMTABSIZE-1] = { -1, 0, NULL, "" }};
+
+/**
+ *  \brief Storing an open shared memory object in the table.
+ *
+ *  \param fd file descriptor of the object
+ *  \param size size of the object
+ *  \param name name of the object
+ *
+ *  \return block identifier, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+static int shmStore (int fd, size_t size, const char *name)
+{
+  int shmid;                                                                                    /* block identifier */
+
+  for (shmid = 0; (shmid < SHMTABSIZE) && (shmTab[shmid].fd != -1); shmid++)
+    ;
+  if (shmid == SHMTABSIZE)
+     { errno = EMFILE;
+       return -1;
+     }
+  shmTab[shmid].fd = fd;
+  shmTab[shmid].size = size;
+  shmTab[shmid].addr = NULL;
+  strcpy (shmTab[shmid].name, name);
+  return shmid;
+}
+
+/**
+ *  \brief Getting a block from the table.
+ *
+ *  \param shmid block identifier
+ *
+ *  \return pointer to the table entry, upon success
+ *  \return NULL, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+static SHM_ENTRY *shmGet (int shmid)
+{
+  if ((shmid < 0) || (shmid >= SHMTABSIZE) || (shmTab[shmid].fd == -1))
+     { errno = EINVAL;
+       return NULL;
+     }
+  return &shmTab[shmid];
+}
+
+/**
+ *  \brief Creation of a new block.
+ *
+ *  The function fails if there is already a block of shared memory with a creation key equal to <tt>key</tt>.
+ *
+ *  \param key creation key
+ *  \param size block size (in bytes)
+ *
+ *  \return block identifier, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+int shmemCreate (int key, unsigned int size)
+{
+  char name[32];                                                                /* name of the shared memory object */
+  size_t len = size;
+  int fd, shmid;
+
+#ifdef SHM_HUGEPAGES
+  len = (len + HUGEPAGESIZE - 1) & ~(HUGEPAGESIZE - 1);
+#endif
+  sprintf (name, SHMNAME, key);
+  if ((fd = shm_open (name, O_RDWR | O_CREAT | O_EXCL, MASK)) == -1)
+     return -1;
+  if ((ftruncate (fd, (off_t) len) == -1) || ((shmid = shmStore (fd, len, name)) == -1))
+     { int err = errno;
+
+       close (fd);
+       shm_unlink (name);
+       errno = err;
+       return -1;
+     }
+  return shmid;                                                                  /* the contents are all 0 bytes */
+}
+
+/**
+ *  \brief Connection to a previously created block.
+ *
+ *  The function fails if there is no block with a creation key equal to <tt>key</tt>.
+ *
+ *  \param key creation key
+ *
+ *  \return block identifier, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+int shmemConnect (int key)
+{
+  char name[32];                                                                /* name of the shared memory object */
+  struct stat st;
+  int fd, shmid;
+
+  sprintf (name, SHMNAME, key);
+  if ((fd = shm_open (name, O_RDWR, MASK)) == -1)
+     return -1;
+  if ((fstat (fd, &st) == -1) || ((shmid = shmStore (fd, (size_t) st.st_size, name)) == -1))
+     { int err = errno;
+
+       close (fd);
+       errno = err;
+       return -1;
+     }
+  return shmid;
+}
+
+/**
+ *  \brief Destruction of a previously created block.
+ *
+ *  The name of the object is removed at once; the memory is released when the last process unmaps it.
+ *  The function fails if there is no block with an identifier equal to <tt>shmid</tt>.
+ *
+ *  \param shmid block identifier
+ *
+ *  \return \c 0, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+int shmemDestroy (int shmid)
+{
+  SHM_ENTRY *e;
+  int stat;
+
+  if ((e = shmGet (shmid)) == NULL)
+     return -1;
+  stat = shm_unlink (e->name);
+  close (e->fd);
+  e->fd = -1;
+  return stat;
+}
+
+/**
+ *  \brief Destruction of a block left behind, given its creation key.
+ *
+ *  The name of the object is removed; the memory is released when the last process unmaps it.
+ *  The function fails if there is no block with a creation key equal to <tt>key</tt>.
+ *
+ *  \param key creation key
+ *
+ *  \return \c 0, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+int shmemReclaim (int key)
+{
+  char name[32];                                                                /* name of the shared memory object */
+
+  sprintf (name, SHMNAME, key);
+  return shm_unlink (name);
+}
+
+/**
+ *  \brief Mapping of the block previously created on the process address space.
+ *
+ *  The function fails if there is no block with an identifier equal to <tt>shmid</tt>.
+ *
+ *  \param shmid block identifier
+ *  \param pAttAdd pointer to the location where the local address of the attached block is stored
+ *
+ *  \return \c 0, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+int shmemAttach (int shmid, void **pAttAdd)
+{
+  SHM_ENTRY *e;
+  void *add;                                                                                    /* temporary pointer */
+
+  if ((e = shmGet (shmid)) == NULL)
+     return -1;
+  if ((add = mmap (NULL, e->size, PROT_READ | PROT_WRITE, MAP_SHARED, e->fd, 0)) == MAP_FAILED)
+     return -1;
+#ifdef SHM_HUGEPAGES
+  madvise (add, e->size, MADV_HUGEPAGE);                                     /* only a hint: failure is harmless */
+#endif
+  e->addr = add;
+  *pAttAdd = add;
+  return 0;
+}
+
+/**
+ *  \brief Unmapping of the block off the process address space.
+ *
+ *  The function fails if the pointer does not locate a region of the address space
+ *  where a mapping took previously place.
+ *  As with the SVIPC implementation, the block identifier remains valid and the block may be mapped again.
+ *
+ *  \param attAdd local address of the attached block
+ *
+ *  \return \c 0, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+int shmemDettach (void *attAdd)
+{
+  int shmid;
+
+  for (shmid = 0; shmid < SHMTABSIZE; shmid++)
+    if ((shmTab[shmid].fd != -1) && (shmTab[shmid].addr == attAdd))
+       { if (munmap (attAdd, shmTab[shmid].size) == -1)
+            return -1;
+         shmTab[shmid].addr = NULL;
+         return 0;
+       }
+  errno = EINVAL;
+  return -1;
+}
+
+#endif /* SHM_POSIX */
@@ -0,0 +1,210 @@
+/**
+ *  \file shmBench.c (implementation file)
+ *
+ *  \brief Problem name: Air Lift.
+ *
+ *  Benchmark of the shared memory implementations.
+ *
+ *  The same source is built once for every implementation of <tt>sharedMemory.h</tt> (see the <tt>bench</tt>
+ *  target of the Makefile and <tt>shmBench.sh</tt>), so that they can be compared side by side on a region with a
+ *  slot per passenger, scaled far beyond the size of the simulation. The following figures are measured:
+ *    \li <tt>create</tt>: creating and mapping the region
+ *    \li <tt>touch</tt>: writing every page of the region for the first time, and the page faults it takes
+ *    \li <tt>connect</tt>: connecting to and mapping the region from another process, and reading every slot
+ *    \li <tt>random</tt>: updating slots at random (the access pattern of the passengers' state).
+ *
+ *  The amount of the region mapped with huge pages (<tt>ShmemPmdMapped</tt> of <tt>/proc/self/smaps_rollup</tt>)
+ *  is written as well.
+ *
+ *  Upon execution, the following parameters are accepted:
+ *    \li <tt>-n slots</tt>: number of passenger slots (100000, by default)
+ *    \li <tt>-b bytes</tt>: size of a slot (64, by default)
+ *    \li <tt>-a accesses</tt>: number of accesses of the <tt>random</tt> test (10000000, by default).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/types.h>
+#include <sys/ipc.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+
+#include "sharedMemory.h"
+
+/** \brief name of the shared memory implementation */
+#if defined (SHM_POSIX) && defined (SHM_HUGEPAGES)
+#define  BACKEND        "thp"
+#elif defined (SHM_POSIX)
+#define  BACKEND        "posix"
+#else
+#define  BACKEND        "sysv"
+#endif
+
+/** \brief page size assumed when touching the region */
+#define  PAGESIZE       4096
+
+/**
+ *  \brief Getting the present time in ns.
+ */
+
+static double now (void)
+{
+    struct timespec t;
+
+    clock_gettime (CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1e9 + t.tv_nsec;
+}
+
+/**
+ *  \brief Carrying out an operation, aborting the benchmark if it fails.
+ */
+
+static void check (int stat, const char *msg)
+{
+    if (stat == -1) {
+        perror (msg);
+        exit (EXIT_FAILURE);
+    }
+}
+
+/**
+ *  \brief Getting the number of minor page faults of the process so far.
+ */
+
+static long minorFaults (void)
+{
+    struct rusage ru;
+
+    getrusage (RUSAGE_SELF, &ru);
+    return ru.ru_minflt;
+}
+
+/**
+ *  \brief Getting the amount of shared memory of the process mapped with huge pages (in kB).
+ */
+
+static long hugeMapped (void)
+{
+    FILE *fp;
+    char line[128];
+    long kb = 0;
+
+    if ((fp = fopen ("/proc/self/smaps_rollup", "r")) == NULL) {
+        return -1;
+    }
+    while (fgets (line, sizeof (line), fp) != NULL) {
+        if (sscanf (line, "ShmemPmdMapped: %ld kB", &kb) == 1) {
+            break;
+        }
+    }
+    fclose (fp);
+    return kb;
+}
+
+/**
+ *  \brief Main program.
+ *
+ *  Its role is creating the shared region and carrying out the tests.
+ */
+
+int main (int argc, char *argv[])
+{
+    long nSlots = 100000, slotSize = 64, nAcc = 10000000, i;
+    unsigned long size, r = 88172645463325252UL;                                         /* xorshift generator state */
+    unsigned char *region;
+    long flt;
+    int key, shmid, status;
+    double t0;
+    char *tinp;
+    int opt;
+
+    while ((opt = getopt (argc, argv, "n:b:a:")) != -1) {
+        switch (opt) {
+        case 'n':
+            nSlots = strtol (optarg, &tinp, 0);
+            break;
+        case 'b':
+            slotSize = strtol (optarg, &tinp, 0);
+            break;
+        case 'a':
+            nAcc = strtol (optarg, &tinp, 0);
+            break;
+        default:
+            fprintf (stderr, "Usage: %s [-n slots] [-b slot size] [-a accesses]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+        if ((*tinp != '\0') || (nSlots < 1) || (slotSize < (long) sizeof (unsigned int)) || (nAcc < 1)) {
+            fprintf (stderr, "Invalid option value!\n");
+            return EXIT_FAILURE;
+        }
+    }
+    size = (unsigned long) nSlots * (unsigned long) slotSize;
+
+    if ((key = ftok (".", 'c')) == -1) {
+        perror ("error on generating the key");
+        return EXIT_FAILURE;
+    }
+
+    /* creation */
+
+    t0 = now ();
+    check (shmid = shmemCreate (key, (unsigned int) size), "error on creating the shared memory region");
+    check (shmemAttach (shmid, (void **) &region), "error on mapping the shared region");
+    printf ("%-6s %-8s %12.1f us (%lu bytes)\n", BACKEND, "create", (now () - t0) / 1e3, size);
+
+    /* first touch */
+
+    flt = minorFaults ();
+    t0 = now ();
+    for (i = 0; i < (long) size; i += PAGESIZE) {
+        region[i] = 1;
+    }
+    printf ("%-6s %-8s %12.1f us, %ld page faults, %ld kB in huge pages\n", BACKEND, "touch", (now () - t0) / 1e3,
+            minorFaults () - flt, hugeMapped ());
+    fflush (stdout);                                                    /* not to be printed again by the child */
+
+    /* connection from another process, as an intervening entity does */
+
+    t0 = now ();
+    switch (fork ()) {
+    case -1:
+        check (-1, "error on the fork operation");
+        break;
+    case 0:
+        { unsigned char *other;
+          unsigned long sum = 0;
+
+          check (shmid = shmemConnect (key), "error on connecting to the shared memory region");
+          check (shmemAttach (shmid, (void **) &other), "error on mapping the shared region");
+          for (i = 0; i < nSlots; i++) {
+              sum += *(unsigned int *) (other + i * slotSize);
+          }
+          check (shmemDettach (other), "error on unmapping the shared region");
+          exit ((sum != 0) ? EXIT_SUCCESS : EXIT_FAILURE);
+        }
+    }
+    if ((wait (&status) == -1) || !WIFEXITED (status) || (WEXITSTATUS (status) != EXIT_SUCCESS)) {
+        fprintf (stderr, "The connecting process failed!\n");
+        return EXIT_FAILURE;
+    }
+    printf ("%-6s %-8s %12.1f us\n", BACKEND, "connect", (now () - t0) / 1e3);
+
+    /* updates of slots at random */
+
+    t0 = now ();
+    for (i = 0; i < nAcc; i++) {
+        r ^= r << 13;
+        r ^= r >> 7;
+        r ^= r << 17;
+        *(unsigned int *) (region + (r % (unsigned long) nSlots) * (unsigned long) slotSize) += 1;
+    }
+    printf ("%-6s %-8s %12.2f ns/access\n", BACKEND, "random", (now () - t0) / (double) nAcc);
+
+    check (shmemDettach (region), "error on unmapping the shared region");
+    check (shmemDestroy (shmid), "error on destructing the shared region");
+
+    return EXIT_SUCCESS;
+}